@@ -1,4 +1,15 @@
 #include "app_common.h"
+#include <string.h>
 
 char server_address[IP_LEN] = {0};
 int port_number = 0;
+
+void msg_init(Message *msg, int type) {
+    memset(msg, 0, sizeof(*msg));
+    msg->version = MSG_VERSION;
+    msg->type = (uint16_t)type;
+}
+
+int msg_valid(const Message *msg) {
+    return msg->version == MSG_VERSION;
+}
@@ -1,6 +1,8 @@
 #ifndef APP_COMMON_H
 #define APP_COMMON_H
 
+#include <stdint.h>
+
 #define MSG_TYPE_SIZE        1
 #define MSG_TYPE_OBSTACLES   2
 #define MSG_TYPE_INPUT       3
@@ -11,6 +13,10 @@
 #define MSG_TYPE_TARGETS     8
 #define MSG_TYPE_FORCE       9
 #define MSG_TYPE_PID         10
+#define MSG_TYPE_SWARM       11
+#define MSG_TYPE_WORLD_DELTA 12
+#define MSG_TYPE_RESYNC      13
+#define MSG_TYPE_DRONE_GONE  14
 
 #define MODE_STANDALONE 1
 #define MODE_NETWORKED  2
@@ -42,12 +48,71 @@
 extern char server_address[IP_LEN];
 extern int port_number;
 
-// ----- MODEL STRUCTURES -----
+// ----- MESSAGE PROTOCOL -----
+// Binary pipe messages: a version/type header and a typed payload per MSG_TYPE_*.
+// Floats travel as raw IEEE values (no text round trip, full precision).
+#define MSG_VERSION 6   // Bump on any payload layout change (1 = old text payloads, 2 = no world version, 3 = no drone id, 4 = no drone timestamp, 5 = deltas by index)
+
+typedef struct { int32_t width, height; } MsgSize;   // SIZE
+typedef struct { char key; } MsgInput;               // INPUT
+typedef struct { float x, y; } MsgPosition;          // POSITION
+typedef struct {                                     // DRONE, DRONE_GONE (id only): remote drone `id`
+    float x, y;
+    int32_t id;
+    uint32_t t_ms;                                   // When it was at (x, y), on its sender's clock
+} MsgDrone;
+typedef struct {                                     // OBSTACLES, TARGETS, SWARM (array follows)
+    int32_t count;
+    uint32_t version;                                // World version of an OBSTACLES/TARGETS snapshot
+} MsgArray;
+typedef struct {                                     // FORCE
+    float drn_Fx, drn_Fy;
+    float obst_Fx, obst_Fy;
+    float wall_Fx, wall_Fy;
+    float targ_Fx, targ_Fy;
+} MsgForce;
+
+// World delta: one obstacle/target added, removed or moved (blackboard -> drone)
+#define ENTITY_OBSTACLE 0
+#define ENTITY_TARGET   1
+#define DELTA_ADD    0   // A new entry at (x, y)
+#define DELTA_REMOVE 1   // The entry at (from_x, from_y) is gone
+#define DELTA_MOVE   2   // The entry at (from_x, from_y) now sits at (x, y)
+
+/* * Entries are named by position, not by index: any of several entries on one
+ * cell will do, so each side keeps its array in whatever order suits it.
+ */
+typedef struct {                                     // WORLD_DELTA
+    uint32_t version;                                // Snapshot/previous delta version + 1
+    uint8_t entity;
+    uint8_t op;
+    int32_t from_x, from_y;
+    int32_t x, y;
+} MsgDelta;
+
 typedef struct {
-    int type;
-    char data[80];
+    uint16_t version;
+    uint16_t type;
+    union {
+        MsgSize size;
+        MsgInput input;
+        MsgPosition pos;
+        MsgDrone drone;
+        MsgArray array;
+        MsgForce force;
+        MsgDelta delta;
+        unsigned char raw[80];
+    } data;
 } Message;
 
+// Sets version and type and clears the payload
+void msg_init(Message *msg, int type);
+
+// 1 if the message was built with this MSG_VERSION (others must be dropped)
+int msg_valid(const Message *msg);
+
+// ----- MODEL STRUCTURES -----
+
 typedef struct {
     int x;
     int y;
@@ -57,6 +122,7 @@ typedef struct {
     float x, y;
     float x_1, x_2;
     float y_1, y_2;
+    float vx, vy;      // Velocity (used by the integrators in integrator.c)
     float Fx, Fy;
 } Drone;
 
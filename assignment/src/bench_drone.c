@@ -0,0 +1,271 @@
+/* ======================================================================================
+ * FILE: bench_drone.c
+ * Headless physics benchmark / replay: no konsole, ncurses, pipes or watchdog.
+ * 1. Load a map (window size, obstacles, targets; fixed or seeded random)
+ * 2. Load a keystroke trace ("<ms> <key>" lines, same keys as the input process)
+ * 3. Run the drone physics step by step, as fast as the CPU allows
+ * 4. Report ns/step, steps/s and checksums of the final state
+ * Options are read from params.txt exactly like the drone process.
+ * Usage: bench_drone <map file> <trace file> [steps] [seed]
+ * ====================================================================================== */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "app_common.h"
+#include "log.h"
+#include "params.h"
+#include "force_kernel.h"
+#include "drone_physics.h"
+
+#define BENCH_DEFAULT_STEPS 60000   // 60 s of simulated time (1 step = 1 ms, as in drone.c)
+#define BENCH_DEFAULT_SEED  42
+
+typedef struct {
+    long step;   // Physics step at which the key is applied
+    char key;
+} TraceEvent;
+
+/* Growable point array: maps can hold any number of obstacles and targets */
+typedef struct {
+    Point *pts;
+    int n, cap;
+} PointList;
+
+// --- MAP / TRACE LOADING ---
+
+static int add_point(PointList *l, int x, int y) {
+    if (l->n == l->cap) {
+        int cap = l->cap ? l->cap * 2 : 64;
+        Point *tmp = realloc(l->pts, sizeof(Point) * cap);
+        if (!tmp) return -1;
+        l->pts = tmp;
+        l->cap = cap;
+    }
+    l->pts[l->n].x = x;
+    l->pts[l->n].y = y;
+    l->n++;
+    return 0;
+}
+
+/* * Random free cells inside the borders, drawn from the seeded generator so
+ * that a given seed always produces the same map.
+ */
+static int add_random_points(PointList *l, int n, int w, int h, unsigned int *seed) {
+    for (int i = 0; i < n; i++) {
+        int x = rand_r(seed) % (w - 2) + 1;
+        int y = rand_r(seed) % (h - 2) + 1;
+        if (add_point(l, x, y) < 0) return -1;
+    }
+    return 0;
+}
+
+/* * Map file, one directive per line ('#' starts a comment):
+ *   size <w> <h>
+ *   obstacle <x> <y>        target <x> <y>
+ *   random_obstacles <n>    random_targets <n>
+ */
+static int load_map(const char *path, unsigned int *seed, int *w, int *h, PointList *obst, PointList *targ) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        perror(path);
+        return -1;
+    }
+    char line[256], key[64];
+    int a, b, ln = 0, err = 0;
+    *w = 0; *h = 0;
+    while (!err && fgets(line, sizeof(line), fp)) {
+        ln++;
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+        int n = sscanf(line, "%63s %d %d", key, &a, &b);
+        if (n <= 0) continue;
+
+        if (strcmp(key, "size") == 0 && n == 3) {
+            *w = a; *h = b;
+        } else if (strcmp(key, "obstacle") == 0 && n == 3) {
+            err = add_point(obst, a, b);
+        } else if (strcmp(key, "target") == 0 && n == 3) {
+            err = add_point(targ, a, b);
+        } else if (strcmp(key, "random_obstacles") == 0 && n >= 2 && *w > 2 && *h > 2) {
+            err = add_random_points(obst, a, *w, *h, seed);
+        } else if (strcmp(key, "random_targets") == 0 && n >= 2 && *w > 2 && *h > 2) {
+            err = add_random_points(targ, a, *w, *h, seed);
+        } else {
+            fprintf(stderr, "%s:%d: ignored '%s' (random_* needs a size first)\n", path, ln, key);
+        }
+    }
+    fclose(fp);
+    if (err) {
+        fprintf(stderr, "%s:%d: out of memory for the map points\n", path, ln);
+        return -1;
+    }
+    if (*w <= 2 || *h <= 2) {
+        fprintf(stderr, "%s: missing or invalid 'size'\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+/* Trace file: "<ms> <key>" per line, in increasing time order */
+static TraceEvent* load_trace(const char *path, int *count) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        perror(path);
+        return NULL;
+    }
+    TraceEvent *ev = NULL;
+    int n = 0, cap = 0;
+    char line[128];
+    long ms;
+    char key;
+    while (fgets(line, sizeof(line), fp)) {
+        if (line[0] == '#' || sscanf(line, "%ld %c", &ms, &key) != 2) continue;
+        if (n == cap) {
+            cap = cap ? cap * 2 : 64;
+            TraceEvent *tmp = realloc(ev, sizeof(TraceEvent) * cap);
+            if (!tmp) break;
+            ev = tmp;
+        }
+        ev[n].step = ms;   // 1 physics step per ms
+        ev[n].key = key;
+        n++;
+    }
+    fclose(fp);
+    *count = n;
+    return ev ? ev : calloc(1, sizeof(TraceEvent));
+}
+
+// --- CHECKSUMS (FNV-1a 64 over the raw float bits) ---
+static uint64_t fnv1a(uint64_t h, const void *data, size_t len) {
+    const unsigned char *p = data;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+
+static uint64_t drone_checksum(uint64_t h, const Drone *d) {
+    float s[8] = { d->x, d->y, d->x_1, d->y_1, d->x_2, d->y_2, d->vx, d->vy };
+    return fnv1a(h, s, sizeof(s));
+}
+
+static long elapsed_ns(struct timespec t1, struct timespec t2) {
+    return (t2.tv_sec - t1.tv_sec) * 1000000000L + (t2.tv_nsec - t1.tv_nsec);
+}
+
+// --- MAIN ---
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <map file> <trace file> [steps] [seed]\n", argv[0]);
+        return 1;
+    }
+    long total_steps = argc > 3 ? atol(argv[3]) : BENCH_DEFAULT_STEPS;
+    unsigned int seed = argc > 4 ? (unsigned int)strtoul(argv[4], NULL, 10) : BENCH_DEFAULT_SEED;
+    unsigned int map_seed = seed;
+
+    PointList obst = {0}, targ = {0};
+    int w, h, n_events;
+    if (load_map(argv[1], &map_seed, &w, &h, &obst, &targ) < 0) return 1;
+    TraceEvent *events = load_trace(argv[2], &n_events);
+    if (!events) return 1;
+
+    // Same setup order as drone.c: options, window size, then the entity arrays
+    force_kernel_init();
+    PhysicsWorld world = {0};
+    WorkerScratch scratch = {0};
+    Swarm swarm = {0};
+    world_load_params(&world);
+    world_resize(&world, w, h);
+    world_set_obstacles(&world, obst.pts, obst.n);
+    world_set_targets(&world, targ.pts, targ.n);
+
+    Drone drn = {0};
+    drone_reset(&drn, w / 2.0f, h / 2.0f);
+
+    int swarm_size = param_int("DRONE_SWARM_SIZE", 0);
+    if (swarm_size > 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        int threads = param_int("DRONE_SWARM_THREADS", cpus > 0 ? (int)cpus : 1);
+        if (swarm_init(&swarm, swarm_size, threads) < 0) return 1;
+        swarm_spawn(&swarm, drn.x, drn.y, w, h);
+        world.adaptive_step = false;
+    }
+
+    // --- RUN: one base tick per loop, like the drone's 1ms scheduler ---
+    DroneForces frc = {0};
+    long owed_steps = 0;
+    int stride = 1, next_event = 0;
+    uint64_t traj = FNV_OFFSET;
+    struct timespec t_start, t_end;
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+
+    for (long tick = 0; tick < total_steps; tick++) {
+        while (next_event < n_events && events[next_event].step <= tick) {
+            drone_apply_key(&drn, events[next_event].key);
+            next_event++;
+        }
+
+        if (swarm.count > 0) {
+            SwarmCtx sctx = { &world, drn.Fx, drn.Fy, &frc };
+            swarm_step(&swarm, swarm_drone_step, &sctx);
+            drn.x = swarm.x[0];
+            drn.y = swarm.y[0];
+        } else {
+            owed_steps++;
+            while (owed_steps >= stride) {
+                physics_step(&world, &drn, &frc, stride * DT, &scratch);
+                owed_steps -= stride;
+                stride = choose_stride(&world, &frc);
+            }
+        }
+        traj = fnv1a(traj, &drn.x, sizeof(float));
+        traj = fnv1a(traj, &drn.y, sizeof(float));
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t_end);
+    world_collect_evals(&world, swarm.count > 0 ? swarm.scratch : &scratch, swarm.count > 0 ? swarm.threads : 1);
+    double ns = (double)elapsed_ns(t_start, t_end);
+
+    // --- REPORT ---
+    uint64_t state = FNV_OFFSET;
+    if (swarm.count == 0) {
+        state = drone_checksum(state, &drn);
+    } else {
+        for (int i = 0; i < swarm.count; i++) {
+            Drone d = { .x = swarm.x[i], .y = swarm.y[i], .x_1 = swarm.x_1[i], .y_1 = swarm.y_1[i],
+                        .x_2 = swarm.x_2[i], .y_2 = swarm.y_2[i], .vx = swarm.vx[i], .vy = swarm.vy[i] };
+            state = drone_checksum(state, &d);
+        }
+    }
+
+    printf("map %s (%dx%d, %d obstacles, %d targets), trace %s (%d keys), seed %u\n",
+           argv[1], w, h, world.num_obstacles, world.num_targets, argv[2], n_events, seed);
+    printf("integrator %s, kernel %s, field %s, adaptive %s, swarm %d\n",
+           integrator_name(world.integrator), force_kernel_name(),
+           world.use_field ? "on" : "off", world.adaptive_step ? "on" : "off", swarm.count);
+    printf("steps %ld in %.3f ms: %.1f ns/step, %.0f steps/s, %lu force evaluations\n",
+           total_steps, ns / 1e6, total_steps > 0 ? ns / total_steps : 0.0,
+           ns > 0 ? total_steps * 1e9 / ns : 0.0, world.evals);
+    printf("final x %.6f y %.6f vx %.6f vy %.6f Fx %.1f Fy %.1f\n",
+           drn.x, drn.y, drn.vx, drn.vy, drn.Fx, drn.Fy);
+    printf("checksum state %016llx trajectory %016llx\n",
+           (unsigned long long)state, (unsigned long long)traj);
+
+    logMessage(LOG_PATH, "[BENCH] %ld steps, %.1f ns/step, state %016llx trajectory %016llx",
+               total_steps, total_steps > 0 ? ns / total_steps : 0.0,
+               (unsigned long long)state, (unsigned long long)traj);
+
+    swarm_free(&swarm);
+    grid_hits_free(&scratch.hits);
+    soa_free(&scratch.soa);
+    world_free(&world);
+    free(events);
+    return 0;
+}
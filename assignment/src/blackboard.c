@@ -6,8 +6,8 @@
  * global variables for game state management, and internal state monitoring structures.
  */
 
-#include <ncurses.h>
 #include <stdlib.h>
+#include <stdbool.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <fcntl.h>
@@ -18,7 +18,6 @@
 #include <time.h>
 #include <sys/stat.h>
 #include <sys/types.h>
-#include <sys/select.h> 
 #include <sys/file.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -29,19 +28,33 @@
 #include "app_common.h"
 #include "process_pid.h"
 #include "log.h"
+#include "drone_shm.h"
+#include "ipc_frame.h"
+#include "ipc_ring.h"
+#include "reactor.h"
+#include "renderer.h"
+#include "params.h"
+#include "world_grid.h"
+#include "remote_drone.h"
 
 #define BUFSZ 256
 #define OBSTACLE_PERIOD_SEC 5
+#define RENDER_FPS_DEFAULT 60    // BB_RENDER_FPS in params.txt
+#define RENDER_FPS_MAX 240
+#define RENDER_STATS_PERIOD_SEC 10
+#define DIRTY_CELLS_MAX 64       // More changed cells in one frame: full repaint instead
+#define REMOTE_DELAY_DEFAULT -1  // BB_REMOTE_DELAY_MS: render delay behind remote updates (-1 = auto)
+#define REMOTE_EXTRAP_DEFAULT 100   // BB_REMOTE_EXTRAP_MS: dead reckoning past the newest update
 
 /* * Internal Process State Enumeration
  * Used to track what the Blackboard is currently doing for logging and debugging purposes.
  */
 typedef enum {
     STATE_INIT,                 // Initialization phase
-    STATE_IDLE,                 // Waiting in select()
+    STATE_IDLE,                 // Waiting in epoll_wait()
     STATE_PROCESSING_INPUT,     // Handling Keyboard Input
     STATE_UPDATING_MAP,         // Updating Obstacles/Targets logic
-    STATE_RENDERING,            // Drawing to Ncurses
+    STATE_RENDERING,            // Drawing the scene
     STATE_BROADCASTING          // Sending data via Pipes/Sockets
 } BBProcessState;
 
@@ -61,19 +74,45 @@ static int current_mode = MODE_STANDALONE;
 static int current_role = 0; // 0 = None, 1 = Server, 2 = Client
 
 /* Timing and Optimization Globals */
-static struct timespec last_obst_change = {0, 0};
 static char last_status[256] = ""; // Caching string to avoid unnecessary redraws
 
 /* Dynamic Game Entities */
 static float current_x = 1.0f, current_y = 1.0f; // Local Drone Coordinates
 static Point *obstacles = NULL;
 static int num_obstacles = 0;
+static RemoteDrone *remote = NULL;   // Networked: the remote drone behind each obstacle
+static int *remote_next = NULL;      // Networked: next remote drone on the same cell (-1 = last), the first is in `world`
+static int *remote_slot = NULL;      // Networked: obstacle index of each drone id, -1 if none
 static Point *targets = NULL;
 static int num_targets = 0;
 static int target_reached = 0;
+static float *swarm_xy = NULL;   // Swarm mode: x, y pairs of every local drone
+static int num_swarm = 0;
+static DroneShm *state_shm = NULL;   // Drone state published by the drone (argv[14], "-" = none)
+static uint64_t last_frame = 0;      // Last snapshot consumed
+static uint32_t world_version = 0;   // Bumped by every obstacle/target change sent to the drone
+static WorldGrid world = {0};        // Cell -> obstacle/target index, kept in step with both arrays
+
+/* Render scheduler: events only mark the scene dirty, the frame tick draws it */
+static int render_fps = RENDER_FPS_DEFAULT;
+static int remote_delay_ms = REMOTE_DELAY_DEFAULT;
+static int remote_extrap_ms = REMOTE_EXTRAP_DEFAULT;
+static int scene_dirty = 0;
+static int status_dirty = 0;
+static unsigned long frames_drawn = 0;
+static unsigned long updates_coalesced = 0;   // Updates folded into an already pending frame
+
+/* Dirty cells: only the cells changed since the last frame are rewritten */
+static Point dirty_cells[DIRTY_CELLS_MAX];
+static int num_dirty = 0;
+static int full_repaint = 1;       // Whole window (first frame, resize, new obstacle/target set)
+static Point *drawn_drones = NULL; // Drone cells drawn by the last frame
+static int num_drawn_drones = 0;
+static int drawn_drones_cap = 0;
+static unsigned long full_repaints = 0;
 
 /* System Handles */
-static WINDOW *status_win = NULL;
+static Renderer *renderer = NULL;   // Active backend (the status bar is updated from anywhere)
 static pid_t watchdog_pid = -1;
 
 /* Helper Macros */
@@ -81,7 +120,8 @@ static pid_t watchdog_pid = -1;
     logMessage(LOG_PATH, "[BB][%s] %s", state_to_str(bb_monitor.current_state), msg)
 
 /* Function Prototypes */
-void reposition_and_redraw(WINDOW **win_ptr, int req_h, int req_w);
+void reposition_and_redraw(Renderer *rnd, int req_h, int req_w);
+void draw_drone(Renderer *rnd, float x, float y);
 
 /*
  * Helper: Updates the internal state monitor
@@ -151,26 +191,34 @@ void watchdog_ping_handler(int sig) {
 
 /*
  * ======================================================================================
- * MACRO-SECTION 3: NCURSES WINDOW MANAGEMENT
+ * MACRO-SECTION 3: RENDERER BACKEND
  * ======================================================================================
- * Helper wrappers for Ncurses library functions to create, destroy, and manage
- * terminal windows.
+ * The scene is drawn through the renderer interface (renderer.h). BB_RENDERER in
+ * params.txt picks the backend at startup: "ncurses" (default) or "ansi", a
+ * frame buffer that writes one diffed escape sequence per frame. HEADLESS 1
+ * selects "null": same world logic, no terminal, optional frame snapshots.
  */
 
-WINDOW* create_window(int height, int width, int starty, int startx) {
-    WINDOW *win = newwin(height, width, starty, startx);
-    keypad(win, TRUE); // Enable arrow keys
-    box(win, 0, 0);    // Draw border
-    wnoutrefresh(win);
-    return win;
-}
+/* Opens the configured backend, falling back to ncurses if it is unknown or fails */
+Renderer* open_renderer(void) {
+    char name[32];
+    if (param_int("HEADLESS", 0)) snprintf(name, sizeof(name), "null");
+    else param_str("BB_RENDERER", RENDERER_DEFAULT, name, sizeof(name));
+
+    Renderer *rnd = renderer_create(name);
+    if (rnd && rnd->ops->open(rnd) == 0) {
+        logMessage(LOG_PATH, "[BB] Renderer: %s", name);
+        return rnd;
+    }
+    logMessage(LOG_PATH, "[BB] Renderer '%s' unavailable, using %s", name, RENDERER_DEFAULT);
+    renderer_destroy(rnd);
 
-void destroy_window(WINDOW *win) {
-    if (!win) return;
-    werase(win);
-    wnoutrefresh(win);
-    doupdate();
-    delwin(win);
+    rnd = renderer_create(RENDERER_DEFAULT);
+    if (rnd && rnd->ops->open(rnd) != 0) {
+        renderer_destroy(rnd);
+        rnd = NULL;
+    }
+    return rnd;
 }
 
 
@@ -179,78 +227,213 @@ void destroy_window(WINDOW *win) {
  * MACRO-SECTION 4: RENDERING ENGINE
  * ======================================================================================
  * Functions responsible for drawing game entities (Drone, Obstacles, Targets)
- * onto the Ncurses window.
+ * onto the renderer's scene.
  */
 
-void draw_background(WINDOW *win) {
-    werase(win);
-    box(win, 0, 0);
+void draw_background(Renderer *rnd) {
+    rnd->ops->clear(rnd);
+}
+
+/* 1 if (x, y) is inside the border of the scene */
+static int inside_box(Renderer *rnd, int x, int y) {
+    return x > 0 && x < rnd->w - 1 && y > 0 && y < rnd->h - 1;
 }
 
-void draw_obstacles(WINDOW *win) {
-    int max_y, max_x;
-    getmaxyx(win, max_y, max_x);
+void draw_obstacle(Renderer *rnd, int i) {
+    if (!inside_box(rnd, obstacles[i].x, obstacles[i].y)) return;
+    rnd->ops->put(rnd, obstacles[i].x, obstacles[i].y, "O", 1, RC_OBSTACLE);
+}
 
-    for (int i = 0; i < num_obstacles; i++) {
-        int ox = obstacles[i].x;
-        int oy = obstacles[i].y;
-        if (ox > 0 && ox < max_x - 1 && oy > 0 && oy < max_y - 1) {
-            wattron(win, COLOR_PAIR(2));
-            mvwprintw(win, oy, ox, "O"); 
-            wattroff(win, COLOR_PAIR(2));
-        }
+void draw_obstacles(Renderer *rnd) {
+    for (int i = 0; i < num_obstacles; i++) draw_obstacle(rnd, i);
+}
+
+/* Target labels are their sequence number, cut at the right border */
+void draw_target(Renderer *rnd, int i) {
+    int tx = targets[i].x;
+    int ty = targets[i].y;
+    if (!inside_box(rnd, tx, ty)) return;
+
+    char label[12];
+    int len = snprintf(label, sizeof(label), "%d", i + target_reached);
+    if (len > rnd->w - 1 - tx) len = rnd->w - 1 - tx;
+    rnd->ops->put(rnd, tx, ty, label, len, RC_TARGET);
+}
+
+void draw_targets(Renderer *rnd) {
+    for (int i = 0; i < num_targets; i++) draw_target(rnd, i);
+}
+
+/* Cell where the drone at (x, y) is drawn: clamped to stay inside the box */
+Point drone_cell(Renderer *rnd, float x, float y) {
+    Point p = { (int)x, (int)y };
+    if (p.x >= rnd->w - 1) p.x = rnd->w - 2;
+    if (p.y >= rnd->h - 1) p.y = rnd->h - 2;
+    if (p.x < 1) p.x = 1;
+    if (p.y < 1) p.y = 1;
+    return p;
+}
+
+void draw_drone(Renderer *rnd, float x, float y) {
+    Point p = drone_cell(rnd, x, y);
+    rnd->ops->put(rnd, p.x, p.y, "+", 1, RC_DRONE);
+}
+
+void draw_swarm(Renderer *rnd) {
+    for (int i = 0; i < num_swarm; i++) draw_drone(rnd, swarm_xy[2*i], swarm_xy[2*i + 1]);
+}
+
+/* --- Dirty cells --- */
+
+/* Full repaint on the next frame (resize, whole obstacle/target set replaced) */
+void request_repaint(void) {
+    full_repaint = 1;
+}
+
+/* The cell changed since the last frame: it is erased and redrawn on the next one */
+void mark_cell(int x, int y) {
+    if (full_repaint) return;
+    for (int i = 0; i < num_dirty; i++) {
+        if (dirty_cells[i].x == x && dirty_cells[i].y == y) return;
+    }
+    if (num_dirty == DIRTY_CELLS_MAX) {
+        full_repaint = 1;
+        return;
     }
+    dirty_cells[num_dirty].x = x;
+    dirty_cells[num_dirty].y = y;
+    num_dirty++;
 }
 
-void draw_targets(WINDOW *win) {
-    int max_y, max_x;
-    getmaxyx(win, max_y, max_x);
+/* Every cell covered by the label of target `seq` at p */
+void mark_label(Point p, int seq) {
+    int len = snprintf(NULL, 0, "%d", seq);
+    for (int k = 0; k < len; k++) mark_cell(p.x + k, p.y);
+}
 
-    for (int i = 0; i < num_targets; i++) {
-        int tx = targets[i].x;
-        int ty = targets[i].y;
-        if (tx > 0 && tx < max_x - 1 && ty > 0 && ty < max_y - 1) {
-            wattron(win, COLOR_PAIR(3));
-            mvwprintw(win, ty, tx, "%d", i + target_reached);
-            wattroff(win, COLOR_PAIR(3));
+static int cell_dirty(int x, int y) {
+    for (int i = 0; i < num_dirty; i++) {
+        if (dirty_cells[i].x == x && dirty_cells[i].y == y) return 1;
+    }
+    return 0;
+}
+
+/*
+ * Compares the drone cells with the ones drawn by the last frame and marks
+ * both ends of every move, so handlers never track the drone themselves.
+ */
+static void track_drone_cells(Renderer *rnd) {
+    int n = num_swarm > 0 ? num_swarm : 1;
+    if (n > drawn_drones_cap) {
+        Point *tmp = realloc(drawn_drones, sizeof(Point) * n);
+        if (!tmp) {
+            full_repaint = 1;
+            return;
         }
+        drawn_drones = tmp;
+        drawn_drones_cap = n;
     }
+
+    for (int i = 0; i < n; i++) {
+        Point p = num_swarm > 0 ? drone_cell(rnd, swarm_xy[2*i], swarm_xy[2*i + 1])
+                                : drone_cell(rnd, current_x, current_y);
+        if (i < num_drawn_drones) {
+            if (drawn_drones[i].x == p.x && drawn_drones[i].y == p.y) continue;
+            mark_cell(drawn_drones[i].x, drawn_drones[i].y);
+        }
+        mark_cell(p.x, p.y);
+        drawn_drones[i] = p;
+    }
+    for (int i = n; i < num_drawn_drones; i++) mark_cell(drawn_drones[i].x, drawn_drones[i].y);
+    num_drawn_drones = n;
 }
 
-void draw_drone(WINDOW *win, float x, float y) {
-    int max_y, max_x;
-    getmaxyx(win, max_y, max_x);
+/*
+ * Incremental frame: blanks the dirty cells, then redraws whatever lies on them
+ * in the usual stacking order (targets, obstacles, drones on top). Targets and
+ * obstacles are looked up in the world grid; a dirty cell may also be covered
+ * by the label of a target up to `label_max - 1` cells to its left.
+ */
+static void draw_dirty_cells(Renderer *rnd) {
+    for (int i = 0; i < num_dirty; i++) {
+        if (inside_box(rnd, dirty_cells[i].x, dirty_cells[i].y)) {
+            rnd->ops->put(rnd, dirty_cells[i].x, dirty_cells[i].y, " ", 1, RC_DEFAULT);
+        }
+    }
+    if (current_mode == MODE_STANDALONE && num_targets > 0) {
+        int label_max = snprintf(NULL, 0, "%d", num_targets - 1 + target_reached);
+        for (int i = 0; i < num_dirty; i++) {
+            for (int k = 0; k < label_max; k++) {
+                int t = world_target_at(&world, dirty_cells[i].x - k, dirty_cells[i].y);
+                if (t != WORLD_EMPTY && snprintf(NULL, 0, "%d", t + target_reached) > k) draw_target(rnd, t);
+            }
+        }
+    }
+    for (int i = 0; i < num_dirty; i++) {
+        int o = world_obstacle_at(&world, dirty_cells[i].x, dirty_cells[i].y);
+        if (o != WORLD_EMPTY) draw_obstacle(rnd, o);
+    }
+    for (int i = 0; i < num_drawn_drones; i++) {
+        if (cell_dirty(drawn_drones[i].x, drawn_drones[i].y)) {
+            rnd->ops->put(rnd, drawn_drones[i].x, drawn_drones[i].y, "+", 1, RC_DRONE);
+        }
+    }
+}
 
-    int ix = (int)x;
-    int iy = (int)y;
+/*
+ * Master refresh function: rewrites the dirty cells only, or repaints the whole
+ * scene after a resize or a new obstacle/target set, then refreshes the screen.
+ * Event handlers call request_redraw() instead; this runs from render_frame().
+ */
+void redraw_scene(Renderer *rnd) {
+    set_state(STATE_RENDERING); 
+    track_drone_cells(rnd);
 
-    // Boundary clamping to keep drone inside the box
-    if (ix >= max_x - 1) ix = max_x - 2;
-    if (iy >= max_y - 1) iy = max_y - 2;
-    if (ix < 1) ix = 1;
-    if (iy < 1) iy = 1;
+    if (full_repaint) {
+        draw_background(rnd);
+        if(current_mode == MODE_STANDALONE){
+            draw_targets(rnd);
+        }
+        draw_obstacles(rnd);
+        if (num_swarm > 0) draw_swarm(rnd);
+        else draw_drone(rnd, current_x, current_y);
+        full_repaints++;
+    } else {
+        draw_dirty_cells(rnd);
+    }
+    full_repaint = 0;
+    num_dirty = 0;
 
-    wattron(win, COLOR_PAIR(1));
-    mvwprintw(win, iy, ix, "+");
-    wattroff(win, COLOR_PAIR(1));
+    rnd->ops->present(rnd);
 }
 
 /*
- * Master refresh function: Calls all draw sub-routines and refreshes the screen.
+ * Marks the scene as changed. However many updates arrive between two frames,
+ * the scene is drawn once, on the next frame tick.
  */
-void redraw_scene(WINDOW *win) {
-    set_state(STATE_RENDERING); 
-    draw_background(win);
-    
-    if(current_mode == MODE_STANDALONE){
-        draw_targets(win);
+void request_redraw(void) {
+    if (scene_dirty) updates_coalesced++;
+    scene_dirty = 1;
+}
+
+/*
+ * Frame tick: draws the scene if anything changed since the last frame, or only
+ * pushes the status bar if that is all that changed.
+ */
+void render_frame(Renderer *rnd) {
+    if (scene_dirty) {
+        redraw_scene(rnd);
+        frames_drawn++;
+    } else if (status_dirty) {
+        rnd->ops->present(rnd);
     }
-    draw_obstacles(win);
-    draw_drone(win, current_x, current_y);
+    scene_dirty = 0;
+    status_dirty = 0;
+}
 
-    wnoutrefresh(win);
-    wnoutrefresh(status_win);
-    doupdate();
+void log_render_stats(void) {
+    logMessage(LOG_PATH, "[BB] Render: %lu frames drawn (%lu full repaints), %lu updates coalesced (%d FPS)",
+               frames_drawn, full_repaints, updates_coalesced, render_fps);
 }
 
 
@@ -261,66 +444,78 @@ void redraw_scene(WINDOW *win) {
  * Algorithms for collision detection, random generation of entities, and coordinate checks.
  */
 
-int overlaps_target(int x, int y) {
-    for (int i = 0; i < num_targets; i++) {
-        if (targets[i].x == x && targets[i].y == y) return 1;
+/* * Networked: remote drones can share a cell. The world grid holds the first one,
+ * remote_next chains the others, so whoever leaves the cell hands it over directly.
+ */
+static void link_remote_drone(int idx) {
+    Point p = obstacles[idx];
+    remote_next[idx] = world_obstacle_at(&world, p.x, p.y);
+    world_set(&world, ENTITY_OBSTACLE, p, idx);
+}
+
+static void unlink_remote_drone(int idx, Point p) {
+    int head = world_obstacle_at(&world, p.x, p.y);
+    if (head == idx) {
+        if (remote_next[idx] >= 0) world_set(&world, ENTITY_OBSTACLE, p, remote_next[idx]);
+        else world_clear(&world, ENTITY_OBSTACLE, p, idx);
+        return;
+    }
+    for (int i = head; i >= 0; i = remote_next[i]) {
+        if (remote_next[i] == idx) {
+            remote_next[i] = remote_next[idx];
+            return;
+        }
     }
-    return 0;
+}
+
+// Chains again every remote drone after the world grid was rebuilt (which kept one per cell)
+static void relink_remote_drones(void) {
+    for (int i = 0; i < num_obstacles; i++) {
+        Point p = obstacles[i];
+        world_clear(&world, ENTITY_OBSTACLE, p, world_obstacle_at(&world, p.x, p.y));
+    }
+    for (int i = 0; i < num_obstacles; i++) link_remote_drone(i);
+}
+
+/*
+ * Rebuilds the world grid for the current window from both arrays
+ * (new window size, whole obstacle or target set replaced).
+ */
+void rebuild_world(Renderer *rnd) {
+    if (world.w != rnd->w || world.h != rnd->h) {
+        if (world_grid_resize(&world, rnd->w, rnd->h) < 0) {
+            logMessage(LOG_PATH, "[BB] ERROR allocating the %dx%d world grid", rnd->w, rnd->h);
+            return;
+        }
+    }
+    world_grid_rebuild(&world, obstacles, num_obstacles, targets, num_targets);
+    if (remote_next) relink_remote_drones();
 }
 
 /*
  * Generates a new position for a specific obstacle index.
- * Ensures no overlap with existing obstacles or targets.
+ * Ensures no overlap with existing obstacles or targets (one grid lookup per try).
  */
 void generate_new_obstacle(int idx, int width, int height) {
-    int valid;
+    world_clear(&world, ENTITY_OBSTACLE, obstacles[idx], idx);
     do {
-        valid = 1;
         obstacles[idx].x = rand() % (width - 2) + 1;
         obstacles[idx].y = rand() % (height - 2) + 1;
-
-        // Check collision with other obstacles
-        for (int i = 0; i < num_obstacles; i++) {
-            if (i != idx && obstacles[idx].x == obstacles[i].x && obstacles[idx].y == obstacles[i].y) {
-                valid = 0; break;
-            }
-        }
-        // Check collision with targets
-        if (valid && overlaps_target(obstacles[idx].x, obstacles[idx].y)) {
-            valid = 0;
-        }
-    } while (!valid);
+    } while (!world_cell_free(&world, obstacles[idx].x, obstacles[idx].y));
+    world_set(&world, ENTITY_OBSTACLE, obstacles[idx], idx);
 }
 
 /*
  * Generates a new position for a specific target index.
- * Ensures no overlap with obstacles or other targets.
+ * Ensures no overlap with obstacles or other targets (one grid lookup per try).
  */
 void generate_new_target(int idx, int width, int height) {
-    int valid;
+    world_clear(&world, ENTITY_TARGET, targets[idx], idx);
     do {
-        valid = 1;
         targets[idx].x = rand() % (width - 2) + 1;
         targets[idx].y = rand() % (height - 2) + 1;
-
-        // Check collision with Obstacles
-        for (int i = 0; i < num_obstacles; i++) {
-            if (targets[idx].x == obstacles[i].x && targets[idx].y == obstacles[i].y) {
-                valid = 0; break;
-            }
-        }
-
-        // Check collision with other Targets
-        if (valid) {
-            for (int k = 0; k < num_targets; k++) {
-                if (k != idx && targets[k].x == targets[idx].x && targets[k].y == targets[idx].y) {
-                    valid = 0; 
-                    break;
-                }
-            }
-        }
-        
-    } while (!valid);
+    } while (!world_cell_free(&world, targets[idx].x, targets[idx].y));
+    world_set(&world, ENTITY_TARGET, targets[idx], idx);
 
     logMessage(LOG_PATH, "[BB] New target %d position: %d %d", idx, targets[idx].x, targets[idx].y);
 }
@@ -335,7 +530,7 @@ void generate_new_target(int idx, int width, int height) {
 
 void update_dynamic(float x, float y, float drn_Fx, float drn_Fy, float obst_Fx, float obst_Fy, float wall_Fx, float wall_Fy, float targ_Fx, float targ_Fy)
 {
-    if (!status_win) return;
+    if (!renderer) return;
 
     char buffer[256];
     snprintf(buffer, sizeof(buffer),
@@ -343,13 +538,11 @@ void update_dynamic(float x, float y, float drn_Fx, float drn_Fy, float obst_Fx,
         x, y, drn_Fx, drn_Fy, obst_Fx, obst_Fy, wall_Fx, wall_Fy, targ_Fx, targ_Fy
     );
 
-    // Only update if the text has actually changed
+    // Only update if the text has actually changed; shown on the next frame
     if (strcmp(buffer, last_status) != 0) {
         strcpy(last_status, buffer);
-        werase(status_win);
-        mvwprintw(status_win, 0, 0, "%s", buffer);
-        wnoutrefresh(status_win);
-        doupdate();
+        renderer->ops->status(renderer, buffer);
+        status_dirty = 1;
     }
 }
 
@@ -357,40 +550,21 @@ void update_dynamic(float x, float y, float drn_Fx, float drn_Fy, float obst_Fx,
  * Handles window resizing. 
  * If req_h/req_w are 0, it detects terminal size. Otherwise, it forces a specific size (used in networking).
  */
-void reposition_and_redraw(WINDOW **win_ptr, int req_h, int req_w) {
+void reposition_and_redraw(Renderer *rnd, int req_h, int req_w) {
     
     // Auto-detect size if arguments are 0
     if (req_h == 0 || req_w == 0) {
-        if (is_term_resized(LINES, COLS)) {
-            resize_term(0, 0);
-        }
-        req_w = COLS;
-        req_h = LINES - 1;
-    } else {
-        // Force specific size (Client syncing with Server)
-        resize_term(req_h + 1, req_w);
+        rnd->ops->term_size(rnd, &req_w, &req_h);
+        req_h -= 1;   // Status bar
     }
-
-    int startx = 0;
-    int starty = 1;
-
-    if (*win_ptr != NULL) {
-        // Attempt resize, recreate if it fails
-        if (wresize(*win_ptr, req_h, req_w) == ERR || mvwin(*win_ptr, starty, startx) == ERR) {
-            destroy_window(*win_ptr);
-            *win_ptr = create_window(req_h, req_w, starty, startx);
-            
-            wresize(status_win, 1, req_w);
-            mvwin(status_win, 0, 0);
-        }
-    } else {
-        *win_ptr = create_window(req_h, req_w, starty, startx);
-        status_win = newwin(1, req_w, 0, 0);
-    }
-
-    werase(status_win);
-    box(*win_ptr, 0, 0);
-    redraw_scene(*win_ptr);
+    // Otherwise force a specific size (Client syncing with Server)
+    rnd->ops->resize(rnd, req_w, req_h);
+    rebuild_world(rnd);
+
+    // A resize is repainted right away (it also absorbs any pending update)
+    request_repaint();
+    scene_dirty = 1;
+    render_frame(rnd);
     logMessage(LOG_PATH, "[BB] Window Resized to: %dx%d", req_w, req_h);
 }
 
@@ -403,59 +577,564 @@ void reposition_and_redraw(WINDOW **win_ptr, int req_h, int req_w) {
  * via file descriptors (pipes or sockets).
  */
 
-void send_window_size(WINDOW *win, int fd_drone, int fd_obst, int fd_targ) {
+void send_window_size(Renderer *rnd, int fd_drone, int fd_obst, int fd_targ) {
     set_state(STATE_BROADCASTING);
     Message msg;
-    int max_y, max_x;
-    getmaxyx(win, max_y, max_x);
+    int max_y = rnd->h, max_x = rnd->w;
 
-    msg.type = MSG_TYPE_SIZE;
-    snprintf(msg.data, sizeof(msg.data), "%d %d", max_x, max_y);
+    msg_init(&msg, MSG_TYPE_SIZE);
+    msg.data.size.width = max_x;
+    msg.data.size.height = max_y;
 
-    write(fd_drone, &msg, sizeof(msg));
+    frame_send(fd_drone, &msg, NULL, 0);
     if(current_mode == MODE_STANDALONE){
-        write(fd_obst,  &msg, sizeof(msg));
-        write(fd_targ,  &msg, sizeof(msg));
+        frame_send(fd_obst, &msg, NULL, 0);
+        frame_send(fd_targ, &msg, NULL, 0);
     }
 }
 
-void send_window_size_network(WINDOW *win, int fd_network) {
+void send_window_size_network(Renderer *rnd, int fd_network) {
     if (fd_network < 0) return;
     set_state(STATE_BROADCASTING); 
     Message msg;
-    int max_y, max_x;
-    getmaxyx(win, max_y, max_x);
+    int max_y = rnd->h, max_x = rnd->w;
 
-    msg.type = MSG_TYPE_SIZE;
-    snprintf(msg.data, sizeof(msg.data), "%d %d", max_x, max_y);
+    msg_init(&msg, MSG_TYPE_SIZE);
+    msg.data.size.width = max_x;
+    msg.data.size.height = max_y;
     write(fd_network, &msg, sizeof(msg));
 }
 
 void send_drone_position_network(float x, float y, int fd_network) {
     if (fd_network < 0) return;
     Message net_msg;
-    net_msg.type = MSG_TYPE_POSITION; 
-    snprintf(net_msg.data, sizeof(net_msg.data), "%f %f", x, y);
+    msg_init(&net_msg, MSG_TYPE_POSITION);
+    net_msg.data.pos.x = x;
+    net_msg.data.pos.y = y;
     write(fd_network, &net_msg, sizeof(net_msg));
 }
 
-void send_resize(WINDOW *win, int fd_drone) {
+void send_resize(Renderer *rnd, int fd_drone) {
     set_state(STATE_BROADCASTING);
     Message msg;
-    int max_y, max_x;
-    getmaxyx(win, max_y, max_x);
-    msg.type = MSG_TYPE_SIZE;
-    snprintf(msg.data, sizeof(msg.data), "%d %d", max_x, max_y);
-    write(fd_drone, &msg, sizeof(msg));
+    int max_y = rnd->h, max_x = rnd->w;
+    msg_init(&msg, MSG_TYPE_SIZE);
+    msg.data.size.width = max_x;
+    msg.data.size.height = max_y;
+    frame_send(fd_drone, &msg, NULL, 0);
+}
+
+
+/*
+ * Sends the whole obstacle or target array to the drone (startup, new
+ * generation, or a RESYNC request after the drone missed a delta).
+ */
+void send_world_snapshot(int fd_drone, int type) {
+    Message msg;
+    msg_init(&msg, type);
+    const Point *arr = (type == MSG_TYPE_OBSTACLES) ? obstacles : targets;
+    int count = (type == MSG_TYPE_OBSTACLES) ? num_obstacles : num_targets;
+    msg.data.array.count = count;
+    msg.data.array.version = ++world_version;
+    frame_send(fd_drone, &msg, arr, sizeof(Point) * count);
+}
+
+/*
+ * Sends a single-entity change to the drone: one fixed-size message instead of
+ * the whole array, whatever the number of obstacles/targets. `from` is the cell
+ * left (remove, move) and `to` the cell taken (add, move).
+ */
+void send_world_delta(int fd_drone, int entity, int op, Point from, Point to) {
+    Message msg;
+    msg_init(&msg, MSG_TYPE_WORLD_DELTA);
+    msg.data.delta.version = ++world_version;
+    msg.data.delta.entity = entity;
+    msg.data.delta.op = op;
+    msg.data.delta.from_x = from.x;
+    msg.data.delta.from_y = from.y;
+    msg.data.delta.x = to.x;
+    msg.data.delta.y = to.y;
+    frame_send(fd_drone, &msg, NULL, 0);
+}
+
+/*
+ * Reacts to a new local drone position (current_x, current_y): redraws, forwards
+ * it to the network and, in standalone mode, checks the target sequence.
+ */
+void handle_local_position(Renderer *rnd, int fd_drone_write, int fd_targ_write, int fd_network_write) {
+    request_redraw();
+
+    // Forward position to network if applicable
+    if (current_mode == MODE_NETWORKED) {
+        send_drone_position_network(current_x, current_y, fd_network_write);
+    }
+    
+    // Standalone Mode: Check Collisions with Targets
+    if(current_mode == MODE_STANDALONE){
+        int dx = (int)current_x;
+        int dy = (int)current_y;
+
+        int i = world_target_at(&world, dx, dy);
+        if (i != WORLD_EMPTY) {
+            
+            // Logic for Sequential Target Collection
+            if(i == 0){
+                logMessage(LOG_PATH, "[BB] Expected target reached");
+                // Shift array (remove target 0); the targets behind it get their new index in the grid
+                Point reached = targets[i];
+                mark_label(reached, target_reached);
+                world_clear(&world, ENTITY_TARGET, reached, i);
+                for (int j = i; j < num_targets - 1; j++) {
+                    targets[j] = targets[j + 1];
+                    world_set(&world, ENTITY_TARGET, targets[j], j);
+                }
+                target_reached++;
+                num_targets--;
+                
+                // Broadcast the removal
+                set_state(STATE_BROADCASTING);
+                send_world_delta(fd_drone_write, ENTITY_TARGET, DELTA_REMOVE, reached, reached);
+            }
+            else if(i != 0){
+                // Wrong target hit: Respawn it elsewhere
+                logMessage(LOG_PATH, "[BB] Not expected target reached");
+                mark_label(targets[i], i + target_reached);
+
+                Point from = targets[i];
+                int max_y = rnd->h, max_x = rnd->w;
+                generate_new_target(i, max_x, max_y);
+                mark_label(targets[i], i + target_reached);
+
+                set_state(STATE_BROADCASTING);
+                send_world_delta(fd_drone_write, ENTITY_TARGET, DELTA_MOVE, from, targets[i]);
+            }
+            
+
+            // Win Condition
+            if (num_targets == 0) {
+                logMessage(LOG_PATH, "[BB] ALL TARGETS CLEARED");
+                Message out_msg;
+                msg_init(&out_msg, MSG_TYPE_OBSTACLES);
+                out_msg.data.array.count = num_obstacles;
+                frame_send(fd_targ_write, &out_msg, obstacles, sizeof(Point) * num_obstacles);
+            }
+            request_redraw();
+        }
+    }
 }
 
+/*
+ * Reads the newest drone snapshot from shared memory (on every frame tick)
+ * and handles it like a position + force message pair.
+ * Positions that never got rendered are simply overwritten, not queued.
+ */
+void poll_drone_state(Renderer *rnd, int fd_drone_write, int fd_targ_write, int fd_network_write) {
+    DroneSnapshot snap;
+    if (drone_shm_read(state_shm, &snap) < 0 || snap.frame == last_frame) return;
+    last_frame = snap.frame;
+
+    // In swarm mode the positions come with MSG_TYPE_SWARM, only forces are used here
+    const Drone *d = &snap.drone;
+    if (num_swarm == 0 && (d->x != current_x || d->y != current_y)) {
+        current_x = d->x;
+        current_y = d->y;
+        handle_local_position(rnd, fd_drone_write, fd_targ_write, fd_network_write);
+    }
+    update_dynamic(current_x, current_y, d->Fx, d->Fy, snap.repFx, snap.repFy,
+                   snap.repWallFx, snap.repWallFy, snap.abtrFx, snap.abtrFy);
+}
 
 /*
  * ======================================================================================
- * MACRO-SECTION 8: MAIN EXECUTION
+ * MACRO-SECTION 8: EVENT HANDLERS
  * ======================================================================================
- * Entry point. Handles Argument Parsing, Watchdog Synchronization, Ncurses Init,
- * and the main Event Loop (Select Multiplexing).
+ * The main loop is an epoll reactor (reactor.c): every pipe, the keyboard and the
+ * two timers (obstacle period, frame tick) have their own handler below, and the
+ * process sleeps until one of them has work. Handlers share a BBContext.
+ */
+
+typedef struct {
+    Renderer *rnd;
+    int fd_input_read, fd_drone_read, fd_drone_write;
+    int fd_obst_write, fd_obst_read, fd_targ_write, fd_targ_read;
+    int fd_wd_write, fd_network_write, fd_network_read;
+    FrameReader drone_rx, obst_rx, targ_rx;
+    Reactor reactor;
+    int running;                 // Cleared to leave the main loop
+} BBContext;
+
+/*
+ * One frame_fill() on a ready descriptor. At EOF (the child is gone) the
+ * descriptor is unregistered, otherwise it would stay ready forever.
+ */
+int fill_frames(BBContext *c, FrameReader *rx, int fd) {
+    ssize_t n = frame_fill(rx, fd);
+    if (n == 0) {
+        logMessage(LOG_PATH, "[BB] fd %d closed by its writer, no longer watched", fd);
+        reactor_del(&c->reactor, fd);
+    }
+    return n > 0;
+}
+
+/* Local keyboard (stdin): every key queued by the renderer, no polling */
+void on_keyboard(int fd, uint32_t events, void *ctx) {
+    (void)fd; (void)events;
+    BBContext *c = ctx;
+    int ch;
+    if (!c->rnd->ops->key) return;   // Headless
+    while ((ch = c->rnd->ops->key(c->rnd)) != RENDER_KEY_NONE) {
+        set_state(STATE_PROCESSING_INPUT);
+        if (ch == 'q') {
+            c->running = 0;
+            return;
+        }
+        if (ch == RENDER_KEY_RESIZE) {
+            reposition_and_redraw(c->rnd, 0, 0);
+            send_resize(c->rnd, c->fd_drone_write);
+        }
+    }
+}
+
+/* Input process: keys are forwarded to the drone, 'q' shuts everything down */
+void on_input_msg(int fd, uint32_t events, void *ctx) {
+    (void)events;
+    BBContext *c = ctx;
+    Message msg;
+    set_state(STATE_PROCESSING_INPUT);
+    ssize_t n = read(fd, &msg, sizeof(Message));
+    if (n == 0) {
+        reactor_del(&c->reactor, fd);
+        return;
+    }
+    if (n > 0 && msg_valid(&msg) && msg.type == MSG_TYPE_INPUT) {
+        char key = msg.data.input.key;
+        if (key == 'q'){
+            // Handle Quit Sequence
+            Message quit_msg;
+            msg_init(&quit_msg, MSG_TYPE_EXIT);
+            if(current_mode == MODE_STANDALONE){
+                write(c->fd_wd_write, &quit_msg, sizeof(Message));
+                frame_send(c->fd_drone_write, &quit_msg, NULL, 0);
+                frame_send(c->fd_obst_write, &quit_msg, NULL, 0);
+                frame_send(c->fd_targ_write, &quit_msg, NULL, 0);
+            }
+            else{
+                frame_send(c->fd_drone_write, &quit_msg, NULL, 0);
+                write(c->fd_network_write, &quit_msg, sizeof(Message));
+            }
+            c->running = 0;
+            return;
+        }
+        logMessage(LOG_PATH_SC, "[BB] Input received: %c", key);
+        
+        // Forward keypress to Drone Process (same typed message)
+        frame_send(c->fd_drone_write, &msg, NULL, 0);
+    }
+}
+
+/* Networked mode: index of remote drone `id` in the obstacle array, or -1 */
+static int remote_drone_index(int id) {
+    return remote_slot && id >= 0 && id <= REMOTE_ID_MAX ? remote_slot[id] : -1;
+}
+
+static long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+/* * Puts remote drone `idx` (obstacle `idx`) on the cell of (x, y); the local drone
+ * hears about it only when the cell changed.
+ */
+static void place_remote_drone(BBContext *c, int idx, float x, float y, int op) {
+    Point prev = obstacles[idx], cell;
+    cell.x = (int)x;
+    cell.y = (int)y;
+
+    // Clamp values within bounds
+    int max_y = c->rnd->h, max_x = c->rnd->w;
+    if(cell.x >= max_x) cell.x = max_x - 1;
+    if(cell.y >= max_y - 1) cell.y = max_y - 2;
+    if(cell.x < 1) cell.x = 1;
+    if(cell.y < 1) cell.y = 1;
+    if (op == DELTA_MOVE && prev.x == cell.x && prev.y == cell.y) return;
+    obstacles[idx] = cell;
+
+    // Notify local drone about the "obstacle" (remote drone)
+    send_world_delta(c->fd_drone_write, ENTITY_OBSTACLE, op, op == DELTA_MOVE ? prev : cell, cell);
+    if (op == DELTA_MOVE) {
+        mark_cell(prev.x, prev.y);
+        unlink_remote_drone(idx, prev);
+    }
+    mark_cell(cell.x, cell.y);
+    link_remote_drone(idx);
+    request_redraw();
+}
+
+/* * Frame tick, networked: every remote drone where it is now according to its
+ * update history (interpolated, or dead-reckoned past the newest update), so it
+ * glides cell by cell between sparse updates instead of jumping.
+ */
+static void update_remote_drones(BBContext *c) {
+    long now = monotonic_ms();
+    for (int i = 0; i < num_obstacles; i++) {
+        float x = obstacles[i].x, y = obstacles[i].y;
+        int delay = remote_delay_ms >= 0 ? remote_delay_ms : remote_drone_auto_delay(&remote[i]);
+        remote_drone_at(&remote[i], now, delay, remote_extrap_ms, &x, &y);
+        place_remote_drone(c, i, x, y, DELTA_MOVE);
+    }
+}
+
+/* * Network process: the remote drones, treated as obstacles locally. Every remote
+ * drone has an id (0 = the server's drone, then one per client of the server), and
+ * remote[i] keeps the recent updates of the drone on obstacles[i].
+ */
+void on_network_msg(int fd, uint32_t events, void *ctx) {
+    (void)events;
+    BBContext *c = ctx;
+    Message msg;
+    ssize_t n = read(fd, &msg, sizeof(Message));
+    if (n == 0) {
+        reactor_del(&c->reactor, fd);
+        return;
+    }
+    if (n <= 0 || !msg_valid(&msg)) return;
+
+    switch(msg.type){
+        case MSG_TYPE_DRONE: {
+            // Receiving remote drone position, treating it as an obstacle locally
+            int id = msg.data.drone.id;
+            if (id < 0 || id > REMOTE_ID_MAX) break;
+            if (!remote_slot) {
+                remote_slot = malloc(sizeof(int) * (REMOTE_ID_MAX + 1));
+                if (!remote_slot) break;
+                memset(remote_slot, 0xff, sizeof(int) * (REMOTE_ID_MAX + 1));
+            }
+            int idx = remote_slot[id];
+            if (idx < 0) {
+                Point *tmp = realloc(obstacles, sizeof(Point) * (num_obstacles + 1));
+                if (!tmp) break;
+                obstacles = tmp;
+                RemoteDrone *rd = realloc(remote, sizeof(RemoteDrone) * (num_obstacles + 1));
+                if (!rd) break;
+                remote = rd;
+                int *next = realloc(remote_next, sizeof(int) * (num_obstacles + 1));
+                if (!next) break;
+                remote_next = next;
+                idx = num_obstacles++;
+                remote_slot[id] = idx;
+                remote_drone_init(&remote[idx], id);
+                place_remote_drone(c, idx, msg.data.drone.x, msg.data.drone.y, DELTA_ADD);
+            }
+
+            // Drawn from the history on the next frame tick
+            remote_drone_push(&remote[idx], msg.data.drone.t_ms, monotonic_ms(), msg.data.drone.x, msg.data.drone.y);
+            break;
+        }
+        case MSG_TYPE_DRONE_GONE: {
+            // The remote drone left: the last one takes its slot (the drone finds obstacles by cell)
+            int idx = remote_drone_index(msg.data.drone.id);
+            if (idx < 0) break;
+            int last = num_obstacles - 1;
+            Point gone = obstacles[idx];
+            send_world_delta(c->fd_drone_write, ENTITY_OBSTACLE, DELTA_REMOVE, gone, gone);
+            unlink_remote_drone(idx, gone);
+            if (idx != last) {
+                unlink_remote_drone(last, obstacles[last]);
+                obstacles[idx] = obstacles[last];
+                remote[idx] = remote[last];
+                remote_slot[remote[idx].id] = idx;
+                link_remote_drone(idx);
+            }
+            num_obstacles--;
+            remote_slot[msg.data.drone.id] = -1;
+            mark_cell(gone.x, gone.y);
+            logMessage(LOG_PATH, "[BB] Remote drone %d left (%d remote drones)", msg.data.drone.id, num_obstacles);
+            request_redraw();
+            break;
+        }
+        default: break;
+    }
+}
+
+/* Drone process (framed: every complete frame read so far) */
+void on_drone_frames(int fd, uint32_t events, void *ctx) {
+    (void)events;
+    BBContext *c = ctx;
+    Message msg;
+    const void *payload;
+    size_t payload_len;
+    if (!fill_frames(c, &c->drone_rx, fd)) return;
+
+    set_state(STATE_UPDATING_MAP);
+    while (frame_next(&c->drone_rx, &msg, &payload, &payload_len)) {
+        if (!msg_valid(&msg)) continue;
+        switch (msg.type) {
+
+        case MSG_TYPE_POSITION:{
+            current_x = msg.data.pos.x;
+            current_y = msg.data.pos.y;
+            handle_local_position(c->rnd, c->fd_drone_write, c->fd_targ_write, c->fd_network_write);
+            break;
+        }
+
+        case MSG_TYPE_SWARM: {
+            // All swarm positions in one message; drone 0 leads (targets, network)
+            int count = msg.data.array.count;
+            if (count < 0 || payload_len != sizeof(float) * 2 * (size_t)count) break;
+            if (count > num_swarm) {
+                float *tmp = realloc(swarm_xy, sizeof(float) * 2 * count);
+                if (!tmp) break;
+                swarm_xy = tmp;
+            }
+            num_swarm = count;
+            if (count > 0) {
+                memcpy(swarm_xy, payload, payload_len);
+                current_x = swarm_xy[0];
+                current_y = swarm_xy[1];
+                handle_local_position(c->rnd, c->fd_drone_write, c->fd_targ_write, c->fd_network_write);
+            }
+            break;
+        }
+
+        case MSG_TYPE_RESYNC:
+            // The drone missed a world delta: resend both sets in full
+            logMessage(LOG_PATH, "[BB] Drone requested a world resync (version %u)", world_version);
+            send_world_snapshot(c->fd_drone_write, MSG_TYPE_OBSTACLES);
+            send_world_snapshot(c->fd_drone_write, MSG_TYPE_TARGETS);
+            break;
+
+        case MSG_TYPE_FORCE: {
+            // Update force values for the UI status bar
+            const MsgForce *f = &msg.data.force;
+            update_dynamic(current_x, current_y, f->drn_Fx, f->drn_Fy, f->obst_Fx, f->obst_Fy,
+                           f->wall_Fx, f->wall_Fy, f->targ_Fx, f->targ_Fy);
+            break;
+        }
+        default: break;
+        }
+    }
+}
+
+/* Copy of a received point array, NULL (logged) if it cannot be allocated: the caller keeps its old set */
+static Point* copy_points(const void *payload, size_t len, const char *what) {
+    Point *arr = malloc(len);
+    if (!arr) {
+        logMessage(LOG_PATH, "[BB] ERROR allocating %zu bytes of %s, keeping the previous set", len, what);
+        return NULL;
+    }
+    memcpy(arr, payload, len);
+    return arr;
+}
+
+/* Obstacle process: a new obstacle set, forwarded to the drone and the target process */
+void on_obstacle_frames(int fd, uint32_t events, void *ctx) {
+    (void)events;
+    BBContext *c = ctx;
+    Message msg;
+    const void *payload;
+    size_t payload_len;
+    if (!fill_frames(c, &c->obst_rx, fd)) return;
+
+    set_state(STATE_UPDATING_MAP);
+    while (frame_next(&c->obst_rx, &msg, &payload, &payload_len)) {
+        if (!msg_valid(&msg) || msg.type != MSG_TYPE_OBSTACLES) continue;
+        int count = msg.data.array.count;
+        Point *arr;
+        if (count > 0 && payload_len == sizeof(Point) * (size_t)count &&
+            (arr = copy_points(payload, payload_len, "obstacles")) != NULL) {
+            free(obstacles);
+            obstacles = arr;
+            num_obstacles = count;
+            rebuild_world(c->rnd);
+            
+            logMessage(LOG_PATH, "[BB] received %d obstacles", num_obstacles);
+            
+            // Distribute obstacles to Drone & Target Processes
+            set_state(STATE_BROADCASTING);
+            send_world_snapshot(c->fd_drone_write, MSG_TYPE_OBSTACLES);
+            Message out_msg;
+            msg_init(&out_msg, MSG_TYPE_OBSTACLES);
+            out_msg.data.array.count = num_obstacles;
+            frame_send(c->fd_targ_write, &out_msg, obstacles, sizeof(Point) * num_obstacles);
+        }
+        request_repaint();
+        request_redraw();
+    }
+}
+
+/* Target process: a new target set, forwarded to the drone and the obstacle process */
+void on_target_frames(int fd, uint32_t events, void *ctx) {
+    (void)events;
+    BBContext *c = ctx;
+    Message msg;
+    const void *payload;
+    size_t payload_len;
+    if (!fill_frames(c, &c->targ_rx, fd)) return;
+
+    set_state(STATE_UPDATING_MAP);
+    while (frame_next(&c->targ_rx, &msg, &payload, &payload_len)) {
+        if (!msg_valid(&msg) || msg.type != MSG_TYPE_TARGETS) continue;
+        int count = msg.data.array.count;
+        Point *arr;
+        if (count > 0 && payload_len == sizeof(Point) * (size_t)count &&
+            (arr = copy_points(payload, payload_len, "targets")) != NULL) {
+            free(targets);
+            targets = arr;
+            num_targets = count;
+            rebuild_world(c->rnd);
+
+            // Distribute targets to Drone & Obstacle Processes
+            set_state(STATE_BROADCASTING);
+            send_world_snapshot(c->fd_drone_write, MSG_TYPE_TARGETS);
+            Message out_msg;
+            msg_init(&out_msg, MSG_TYPE_TARGETS);
+            out_msg.data.array.count = num_targets;
+            frame_send(c->fd_obst_write, &out_msg, targets, sizeof(Point) * num_targets);
+        }
+        request_repaint();
+        request_redraw();
+    }
+}
+
+/* Obstacle timer (every OBSTACLE_PERIOD_SEC, standalone): relocates one obstacle */
+void on_obstacle_timer(int fd, uint32_t expirations, void *ctx) {
+    (void)fd; (void)expirations;
+    BBContext *c = ctx;
+    if (num_obstacles <= 0) return;
+
+    set_state(STATE_UPDATING_MAP); 
+    int idx = rand() % num_obstacles;
+    int max_y = c->rnd->h, max_x = c->rnd->w;
+    Point from = obstacles[idx];
+    mark_cell(from.x, from.y);
+    generate_new_obstacle(idx, max_x, max_y);
+    mark_cell(obstacles[idx].x, obstacles[idx].y);
+    
+    request_redraw();
+
+    // Broadcast the relocation only
+    set_state(STATE_BROADCASTING); 
+    send_world_delta(c->fd_drone_write, ENTITY_OBSTACLE, DELTA_MOVE, from, obstacles[idx]);
+}
+
+/* Frame tick (BB_RENDER_FPS): newest shared drone state, then at most one frame */
+void on_frame_tick(int fd, uint32_t expirations, void *ctx) {
+    (void)fd; (void)expirations;
+    BBContext *c = ctx;
+    static unsigned long ticks = 0;
+    if (state_shm) poll_drone_state(c->rnd, c->fd_drone_write, c->fd_targ_write, c->fd_network_write);
+    if (current_mode == MODE_NETWORKED) update_remote_drones(c);
+    render_frame(c->rnd);
+    if (++ticks % ((unsigned long)render_fps * RENDER_STATS_PERIOD_SEC) == 0) log_render_stats();
+}
+
+/*
+ * ======================================================================================
+ * MACRO-SECTION 9: MAIN EXECUTION
+ * ======================================================================================
+ * Entry point. Handles Argument Parsing, Watchdog Synchronization, Renderer Init,
+ * and the main Event Loop (epoll reactor).
  */
 
 int main(int argc, char *argv[]) {
@@ -482,6 +1161,17 @@ int main(int argc, char *argv[]) {
     int fd_network_write = atoi(argv[11]);
     int fd_network_read = atoi(argv[12]);
     current_role = atoi(argv[13]);
+    if (argc > 14 && strcmp(argv[14], "-") != 0) state_shm = drone_shm_open(argv[14], 0);
+    render_fps = param_int("BB_RENDER_FPS", RENDER_FPS_DEFAULT);
+    remote_delay_ms = param_int("BB_REMOTE_DELAY_MS", REMOTE_DELAY_DEFAULT);
+    remote_extrap_ms = param_int("BB_REMOTE_EXTRAP_MS", REMOTE_EXTRAP_DEFAULT);
+    if (render_fps < 1) render_fps = 1;
+    if (render_fps > RENDER_FPS_MAX) render_fps = RENDER_FPS_MAX;
+
+    if (argc > 15) {
+        int fds[6] = { fd_drone_read, fd_drone_write, fd_obst_write, fd_obst_read, fd_targ_write, fd_targ_read };
+        if (ring_attach(argv[15], fds, 6) == 0) logMessage(LOG_PATH, "[BB] Shared-memory rings: %s", argv[15]);
+    }
 
     logMessage(LOG_PATH, "[BB] FDs: input=%d drone=%d obst=%d target=%d wd=%d network=%d", 
     fd_input_read, fd_drone_read, fd_obst_write, fd_targ_write, fd_wd_write, fd_network_read);
@@ -515,49 +1205,40 @@ int main(int argc, char *argv[]) {
     flock(fd_pid, LOCK_UN); // Release Lock
     fclose(fp_pid);
 
-    // --- NCURSES INITIALIZATION ---
-    initscr();
-    cbreak();
-    noecho();
-    nodelay(stdscr, TRUE);
-    curs_set(0);
-    start_color();
-    use_default_colors();
-    init_pair(1, COLOR_BLUE, -1);
-    init_pair(2, COLOR_RED, -1);
-    init_pair(3, COLOR_GREEN, -1);
-    refresh();
+    // --- RENDERER INITIALIZATION ---
+    Renderer *rnd = open_renderer();
+    if (!rnd) {
+        fprintf(stderr, "[BB] Error: no renderer could be started\n");
+        return 1;
+    }
+    renderer = rnd;
 
     // --- WINDOW & PROTOCOL HANDSHAKE ---
-    WINDOW *win = NULL;
-    status_win = newwin(1, COLS, 0, 0);
-    win = create_window(LINES - 1, COLS, 1, 0);
-    
-    reposition_and_redraw(&win, 0, 0);
+    reposition_and_redraw(rnd, 0, 0);
     
     // Initial size broadcast
     if (current_mode == MODE_STANDALONE || (current_mode == MODE_NETWORKED && current_role == MODE_SERVER)) {
-        send_window_size(win, fd_drone_write, fd_obst_write, fd_targ_write);
+        send_window_size(rnd, fd_drone_write, fd_obst_write, fd_targ_write);
     }
 
     // Network Synchronization Logic
     if (current_mode == MODE_NETWORKED) {
         if (current_role == MODE_SERVER) {
             // Server: Sends dimensions to Client
-            send_window_size_network(win, fd_network_write);
+            send_window_size_network(rnd, fd_network_write);
         } else {
             // Client: Waits for dimensions from Server
             Message msg;
             ssize_t n = read(fd_network_read, &msg, sizeof(msg));
-            if (n > 0 && msg.type == MSG_TYPE_SIZE) {
-                int width, height;
-                if (sscanf(msg.data, "%d %d", &width, &height) == 2) {
+            if (n > 0 && msg_valid(&msg) && msg.type == MSG_TYPE_SIZE) {
+                int width = msg.data.size.width, height = msg.data.size.height;
+                if (width > 0 && height > 0) {
                     
                     // 1. Resize local window to match Server
-                    reposition_and_redraw(&win, height, width);
+                    reposition_and_redraw(rnd, height, width);
                     
                     // 2. Forward correct size to Local Drone
-                    send_window_size(win, fd_drone_write, fd_obst_write, fd_targ_write);
+                    send_window_size(rnd, fd_drone_write, fd_obst_write, fd_targ_write);
                     
                     logMessage(LOG_PATH, "[BB] Synced size with Server: %dx%d and forwarded to Drone", width, height);
                 }
@@ -565,321 +1246,72 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    // Physics variables initialization
-    float drn_Fx = 0.0f, drn_Fy = 0.0f;
-    float obst_Fx = 0.0f, obst_Fy = 0.0f;
-    float wall_Fx = 0.0f, wall_Fy = 0.0f;
-    float targ_Fx = 0.0f, targ_Fy = 0.0f;
-
     logMessage(LOG_PATH, "[BB] Ready and GUI started");
 
-    fd_set readfds;
-    struct timeval tv;
-    Message msg;
-
     obstacles = malloc(sizeof(Point)); 
     num_obstacles = 0;
+
+    // --- EVENT SOURCES ---
+    BBContext c = {
+        .rnd = rnd,
+        .fd_input_read = fd_input_read, .fd_drone_read = fd_drone_read, .fd_drone_write = fd_drone_write,
+        .fd_obst_write = fd_obst_write, .fd_obst_read = fd_obst_read,
+        .fd_targ_write = fd_targ_write, .fd_targ_read = fd_targ_read,
+        .fd_wd_write = fd_wd_write, .fd_network_write = fd_network_write, .fd_network_read = fd_network_read,
+        .running = 1,
+    };
+    if (reactor_init(&c.reactor) < 0) {
+        renderer_destroy(rnd);
+        return 1;
+    }
+    if (rnd->ops->key) reactor_add(&c.reactor, STDIN_FILENO, EPOLLIN, on_keyboard, &c);
+    reactor_add(&c.reactor, fd_input_read, EPOLLIN, on_input_msg, &c);
+    reactor_add(&c.reactor, fd_drone_read, EPOLLIN, on_drone_frames, &c);
+    if(current_mode == MODE_STANDALONE){
+        reactor_add(&c.reactor, fd_obst_read, EPOLLIN, on_obstacle_frames, &c);
+        reactor_add(&c.reactor, fd_targ_read, EPOLLIN, on_target_frames, &c);
+        reactor_add_timer(&c.reactor, OBSTACLE_PERIOD_SEC * 1000000000L, on_obstacle_timer, &c);
+    }
+    if(current_mode == MODE_NETWORKED){
+        reactor_add(&c.reactor, fd_network_read, EPOLLIN, on_network_msg, &c);
+    }
+    reactor_add_timer(&c.reactor, 1000000000L / render_fps, on_frame_tick, &c);
     
     // --- MAIN EVENT LOOP ---
-    while (1) {
+    while (c.running) {
         set_state(STATE_IDLE); // Reset state before waiting
 
-        // 1. UI Input Handling (Local Keyboard)
-        int ch = getch();
-        if (ch != ERR) {
-            set_state(STATE_PROCESSING_INPUT);
-            if (ch == 'q') break;
-            if (ch == KEY_RESIZE) {
-                reposition_and_redraw(&win, 0, 0);
-                send_resize(win, fd_drone_write);
-            }
-        }
-
-        // 2. Periodic Logic (Obstacle Random Movement)
-        struct timespec now;
-        clock_gettime(CLOCK_MONOTONIC, &now);
-        if (current_mode == MODE_STANDALONE && num_obstacles > 0 && now.tv_sec - last_obst_change.tv_sec >= OBSTACLE_PERIOD_SEC) {
-            set_state(STATE_UPDATING_MAP); 
-            last_obst_change = now;
-            
-            int idx = rand() % num_obstacles;
-            int max_y, max_x;
-            getmaxyx(win, max_y, max_x);
-            generate_new_obstacle(idx, max_x, max_y);
-            
-            redraw_scene(win); 
-
-            // Broadcast update
-            set_state(STATE_BROADCASTING); 
-            Message m;
-            m.type = MSG_TYPE_OBSTACLES;
-            snprintf(m.data, sizeof(m.data), "%d", num_obstacles);
-            write(fd_drone_write, &m, sizeof(m));
-            write(fd_drone_write, obstacles, sizeof(Point) * num_obstacles);
-        }
-
-        // 3. I/O Multiplexing Configuration (Select)
-        FD_ZERO(&readfds);
-        FD_SET(fd_input_read, &readfds);
-        FD_SET(fd_drone_read, &readfds);
-        
-        if(current_mode == MODE_STANDALONE){
-            FD_SET(fd_obst_read, &readfds);
-            FD_SET(fd_targ_read, &readfds); 
-        }
-        if(current_mode == MODE_NETWORKED){
-            FD_SET(fd_network_read, &readfds);
-        }
-        
-        // Calculate max_fd for select()
-        int max_fd = fd_input_read;
-        if (fd_drone_read > max_fd) max_fd = fd_drone_read;
+        // Shared-memory rings: ask for an eventfd wakeup while we sleep
+        frame_wait_prepare(fd_drone_read);
         if(current_mode == MODE_STANDALONE){
-            if (fd_obst_read > max_fd) max_fd = fd_obst_read;
-            if (fd_targ_read > max_fd) max_fd = fd_targ_read;
-        }
-        if(current_mode == MODE_NETWORKED){
-            if (fd_network_read > max_fd) max_fd = fd_network_read;
-        }
-        max_fd += 1;
-
-        tv.tv_sec  = 0;
-        tv.tv_usec = 30000; // 30ms Timeout for fluid rendering
-
-        int ret = select(max_fd, &readfds, NULL, NULL, &tv);
-        if (ret < 0) {
-            if (errno == EINTR) continue;
-            break;
-        }
-
-        // 4. Input Process Handler
-        if (FD_ISSET(fd_input_read, &readfds)) {
-            set_state(STATE_PROCESSING_INPUT);
-            char buf[80];
-            ssize_t n = read(fd_input_read, buf, sizeof(buf)-1);
-            if (n > 0) {
-                buf[n] = '\0';
-                if (buf[0] == 'q'){
-                    // Handle Quit Sequence
-                    Message quit_msg;
-                    quit_msg.type = MSG_TYPE_EXIT;
-                    snprintf(msg.data, sizeof(quit_msg), "%s", buf);
-                    if(current_mode == MODE_STANDALONE){
-                        write(fd_wd_write, &quit_msg, sizeof(Message));
-                        write(fd_drone_write, &quit_msg, sizeof(Message));
-                        write(fd_obst_write, &quit_msg, sizeof(Message));
-                        write(fd_targ_write, &quit_msg, sizeof(Message));
-                    }
-                    else{
-                        write(fd_drone_write, &quit_msg, sizeof(Message));
-                        write(fd_network_write, &quit_msg, sizeof(Message));
-                    }
-                    goto quit;
-                }
-                logMessage(LOG_PATH_SC, "[BB] Input received: %c", buf[0]);
-                
-                // Forward keypress to Drone Process
-                msg.type = MSG_TYPE_INPUT;
-                snprintf(msg.data, sizeof(msg.data), "%s", buf);
-                write(fd_drone_write, &msg, sizeof(Message));
-            }
+            frame_wait_prepare(fd_obst_read);
+            frame_wait_prepare(fd_targ_read);
         }
 
-        // 5. Network Process Handler
-        if(FD_ISSET(fd_network_read, &readfds)){
-            if(read(fd_network_read, &msg, sizeof(Message)) > 0){
-                switch(msg.type){
-                    case MSG_TYPE_DRONE: {
-                        // Receiving remote drone position, treating it as an obstacle locally
-                        float remote_x, remote_y;
-                        if (sscanf(msg.data, "%f %f", &remote_x, &remote_y) == 2) {
-                            if (!obstacles) {
-                                obstacles = malloc(sizeof(Point));
-                            }
-
-                            num_obstacles = 1;
-                            obstacles[0].x = (int)remote_x;
-                            obstacles[0].y = (int)remote_y;
-
-                            // Clamp values within bounds
-                            int max_y, max_x;
-                            getmaxyx(win, max_y, max_x);
-                            if(obstacles[0].x >= max_x) obstacles[0].x = max_x - 1;
-                            if(obstacles[0].y >= max_y - 1) obstacles[0].y = max_y - 2;
-                            if(obstacles[0].x < 1) obstacles[0].x = 1;
-                            if(obstacles[0].y < 1) obstacles[0].y = 1;
-
-                            // Notify local drone about the "obstacle" (remote drone)
-                            Message out_msg;
-                            out_msg.type = MSG_TYPE_OBSTACLES;
-                            snprintf(out_msg.data, sizeof(out_msg.data), "%d", num_obstacles);
-                            write(fd_drone_write, &out_msg, sizeof(Message));
-                            write(fd_drone_write, obstacles, sizeof(Point) * num_obstacles);
-                            
-                            redraw_scene(win);
-                        }
-                        break;
-                    }
-                    default: break;
-                }
-            }
+        // Sleeps until a descriptor or a timer is ready (no timeout, no polling)
+        if (reactor_run_once(&c.reactor, -1) < 0) {
+            if (errno != EINTR) break;
+            // A signal (SIGWINCH on a terminal resize) may have queued RENDER_KEY_RESIZE
+            on_keyboard(STDIN_FILENO, 0, &c);
         }
-
-
-        // 6. Drone Process Handler
-        if (FD_ISSET(fd_drone_read, &readfds)) {
-            set_state(STATE_UPDATING_MAP);
-            if (read(fd_drone_read, &msg, sizeof(msg)) > 0) {
-                switch (msg.type) {
-
-                case MSG_TYPE_POSITION:{
-                    sscanf(msg.data, "%f %f", &current_x, &current_y);
-
-                    redraw_scene(win); 
-
-                    // Forward position to network if applicable
-                    if (current_mode == MODE_NETWORKED) {
-                        send_drone_position_network(current_x, current_y, fd_network_write);
-                    }
-                    
-                    // Standalone Mode: Check Collisions with Targets
-                    if(current_mode == MODE_STANDALONE){
-                        int dx = (int)current_x;
-                        int dy = (int)current_y;
-
-                        for (int i = 0; i < num_targets; i++) {
-                            if (dx == (int)targets[i].x && dy == (int)targets[i].y) {
-                                
-                                // Logic for Sequential Target Collection
-                                if(i == 0){
-                                    logMessage(LOG_PATH, "[BB] Expected target reached");
-                                    // Shift array (remove target 0)
-                                    for (int j = i; j < num_targets - 1; j++) targets[j] = targets[j + 1];
-                                    target_reached++;
-                                    num_targets--;
-                                    
-                                    // Broadcast new target list
-                                    set_state(STATE_BROADCASTING);
-                                    Message out_msg;
-                                    out_msg.type = MSG_TYPE_TARGETS;
-                                    snprintf(out_msg.data, sizeof(out_msg.data), "%d", num_targets);
-                                    write(fd_drone_write, &out_msg, sizeof(out_msg));
-                                    write(fd_drone_write, targets, sizeof(Point) * num_targets);
-                                }
-                                else if(i != 0){
-                                    // Wrong target hit: Respawn it elsewhere
-                                    logMessage(LOG_PATH, "[BB] Not expected target reached");
-                                    targets[i].x = 0;
-                                    targets[i].y = 0;
-
-                                    int max_y, max_x;
-                                    getmaxyx(win, max_y, max_x);
-                                    generate_new_target(i, max_x, max_y);
-
-                                    set_state(STATE_BROADCASTING);
-                                    Message out_msg;
-                                    out_msg.type = MSG_TYPE_TARGETS;
-                                    snprintf(out_msg.data, sizeof(out_msg.data), "%d", num_targets);
-                                    write(fd_drone_write, &out_msg, sizeof(out_msg));
-                                    write(fd_drone_write, targets, sizeof(Point) * num_targets);
-                                }
-                                
-
-                                // Win Condition
-                                if (num_targets == 0) {
-                                    logMessage(LOG_PATH, "[BB] ALL TARGETS CLEARED");
-                                    Message out_msg;
-                                    out_msg.type = MSG_TYPE_OBSTACLES;
-                                    snprintf(out_msg.data, sizeof(out_msg.data), "%d", num_obstacles);
-                                    write(fd_targ_write, &out_msg, sizeof(out_msg));
-                                    write(fd_targ_write, obstacles, sizeof(Point) * num_obstacles);
-                                }
-                                redraw_scene(win);
-                                break; 
-                            }
-                        }
-                    }
-                    break;
-                }
-
-                case MSG_TYPE_FORCE: {
-                    // Update force values for the UI status bar
-                    if (sscanf(msg.data, "%f %f %f %f %f %f %f %f",
-                            &drn_Fx, &drn_Fy, &obst_Fx, &obst_Fy, &wall_Fx, &wall_Fy, &targ_Fx, &targ_Fy) == 8) {
-                        update_dynamic(current_x, current_y, drn_Fx, drn_Fy, obst_Fx, obst_Fy, wall_Fx, wall_Fy, targ_Fx, targ_Fy);
-                    }
-                    break;
-                }
-                default: break;
-                }
-            }
-        }
-
-        // 7. Obstacle Process Handler
-        if (FD_ISSET(fd_obst_read, &readfds)) {
-            set_state(STATE_UPDATING_MAP);
-            if (read(fd_obst_read, &msg, sizeof(msg)) > 0 && msg.type == MSG_TYPE_OBSTACLES) {
-                int count;
-                sscanf(msg.data, "%d", &count);
-                if (count > 0) {
-                    free(obstacles);
-                    obstacles = malloc(sizeof(Point) * count);
-                    read(fd_obst_read, obstacles, sizeof(Point) * count);
-                    num_obstacles = count;
-                    
-                    logMessage(LOG_PATH, "[BB] received %d obstacles", num_obstacles);
-                    
-                    // Distribute obstacles to Drone & Target Processes
-                    set_state(STATE_BROADCASTING);
-                    Message out_msg;
-                    out_msg.type = MSG_TYPE_OBSTACLES;
-                    snprintf(out_msg.data, sizeof(out_msg.data), "%d", num_obstacles);      
-                    
-                    write(fd_drone_write, &out_msg, sizeof(out_msg));
-                    write(fd_drone_write, obstacles, sizeof(Point) * num_obstacles);
-                    
-                    write(fd_targ_write, &out_msg, sizeof(out_msg));
-                    write(fd_targ_write, obstacles, sizeof(Point) * num_obstacles);
-                }
-                redraw_scene(win);
-            }
-        }
-
-        // 8. Target Process Handler
-        if (FD_ISSET(fd_targ_read, &readfds)) {
-            set_state(STATE_UPDATING_MAP);
-            if (read(fd_targ_read, &msg, sizeof(msg)) > 0 && msg.type == MSG_TYPE_TARGETS) {
-                int count;
-                sscanf(msg.data, "%d", &count);
-                if (count > 0) {
-                    free(targets);
-                    targets = malloc(sizeof(Point) * count);
-                    read(fd_targ_read, targets, sizeof(Point) * count);
-                    num_targets = count;
-
-                    // Distribute targets to Drone & Obstacle Processes
-                    set_state(STATE_BROADCASTING);
-                    Message out_msg;
-                    out_msg.type = MSG_TYPE_TARGETS;
-                    snprintf(out_msg.data, sizeof(out_msg.data), "%d", num_targets);
-                    
-                    write(fd_drone_write, &out_msg, sizeof(out_msg));
-                    write(fd_drone_write, targets, sizeof(Point) * num_targets);
-                    
-                    write(fd_obst_write, &out_msg, sizeof(out_msg));
-                    write(fd_obst_write, targets, sizeof(Point) * num_targets);
-                }
-                redraw_scene(win);
-            }
-        }
-
-        usleep(10000); // Brief sleep to prevent 100% CPU usage loop
     }
 
     // --- CLEANUP ---
-    quit:
-    destroy_window(win);
+    log_render_stats();
+    reactor_free(&c.reactor);
     free(obstacles);
-    endwin();
+    free(remote);
+    free(remote_next);
+    free(remote_slot);
+    free(targets);
+    world_grid_free(&world);
+    free(swarm_xy);
+    free(drawn_drones);
+    frame_reader_free(&c.drone_rx);
+    frame_reader_free(&c.obst_rx);
+    frame_reader_free(&c.targ_rx);
+    drone_shm_close(state_shm);
+    renderer = NULL;
+    renderer_destroy(rnd);
     return 0;
 }
\ No newline at end of file
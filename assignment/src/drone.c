@@ -1,9 +1,11 @@
 /* ======================================================================================
  * FILE: drone.c
  * Logic: 
+ * 0. Sleep until the next absolute 1ms deadline (drift-free scheduler)
  * 1. Flush Input Pipe (Handle all pending keys/obstacles)
- * 2. Calculate Physics (High Frequency ~1000Hz)
- * 3. Send Output to Blackboard (Throttled ~30Hz to avoid pipe flooding)
+ * 2. Calculate Physics (High Frequency ~1000Hz, catch-up steps after a stall)
+ * 3. Publish the state in shared memory every step (pipe messages throttled ~30Hz
+ *    when the shared memory is not available, and for the swarm positions)
  * ====================================================================================== */
 #include <stdio.h>
 #include <stdlib.h>
@@ -22,11 +24,21 @@
 #include "app_common.h"
 #include "log.h"
 #include "process_pid.h"
+#include "force_kernel.h"
+#include "params.h"
+#include "step_scheduler.h"
+#include "drone_physics.h"
+#include "drone_shm.h"
+#include "ipc_frame.h"
+#include "ipc_ring.h"
 
 #undef EPSILON
 #define EPSILON 0.001f
 
 #define PHYSICS_DT_SEC 0.001f    // 1ms physics step
+#define PHYSICS_DT_NS 1000000L    // Same step in ns, for the scheduler
+#define SCHED_STATS_PERIOD_NS (10 * 1000000000L)   // Scheduler stats logged every 10s
+
 #define RENDER_FPS 30            // 30 invii al secondo alla blackboard
 #define RENDER_DT_NS (1000000000L / RENDER_FPS)
 
@@ -35,10 +47,12 @@ typedef enum {
     STATE_CALCULATING_PHYSICS, STATE_SENDING_OUTPUT, STATE_IDLE
 } ProcessState;
 
-static Point *obstacles = NULL;
-static int num_obstacles = 0;
-static Point *targets = NULL;
-static int num_targets = 0;
+static PhysicsWorld world = {0};                   // Obstacles, targets and their indexes
+static WorkerScratch main_scratch = {0};           // Query/kernel buffers of the main thread
+static Swarm swarm = {0};                          // DRONE_SWARM_SIZE > 0: multi-drone engine
+static DroneShm *state_shm = NULL;                 // Shared state for the blackboard (argv[5], "-" = none)
+static uint32_t world_version = 0;                 // Version of the last snapshot/delta applied
+static int resync_wait = 0;                        // Snapshots still owed after a RESYNC request
 static volatile pid_t watchdog_pid = -1; 
 static volatile sig_atomic_t current_state = STATE_INIT;
 
@@ -75,19 +89,84 @@ void publish_my_pid(FILE *fp) {
     fprintf(fp, "%s %d\n", DRONE_PID_TAG, getpid());
 }
 
-void send_position(Message msg, float x, float y, int fd_out){
-    msg.type = MSG_TYPE_POSITION;
-    snprintf(msg.data, sizeof(msg.data), "%f %f", x, y);
-    write(fd_out, &msg, sizeof(msg));
+void send_position(float x, float y, int fd_out){
+    Message msg;
+    msg_init(&msg, MSG_TYPE_POSITION);
+    msg.data.pos.x = x;
+    msg.data.pos.y = y;
+    frame_send(fd_out, &msg, NULL, 0);
 }
 
-void send_forces(Message msg, int fd_out, float drone_Fx, float drone_Fy,
+void send_forces(int fd_out, float drone_Fx, float drone_Fy,
                  float obst_Fx, float obst_Fy, float wall_Fx, float wall_Fy,
                  float abtrFx, float abtrFy){
-    msg.type = MSG_TYPE_FORCE;
-    snprintf(msg.data, sizeof(msg.data), "%f %f %f %f %f %f %f %f",
-             drone_Fx, drone_Fy, obst_Fx, obst_Fy, wall_Fx, wall_Fy, abtrFx, abtrFy);
-    write(fd_out, &msg, sizeof(msg));
+    Message msg;
+    msg_init(&msg, MSG_TYPE_FORCE);
+    MsgForce *f = &msg.data.force;
+    f->drn_Fx = drone_Fx; f->drn_Fy = drone_Fy;
+    f->obst_Fx = obst_Fx; f->obst_Fy = obst_Fy;
+    f->wall_Fx = wall_Fx; f->wall_Fy = wall_Fy;
+    f->targ_Fx = abtrFx;  f->targ_Fy = abtrFy;
+    frame_send(fd_out, &msg, NULL, 0);
+}
+
+/* * Publishes the drone state and the force breakdown in shared memory:
+ * binary floats, no formatting and no syscall, so it runs after every step.
+ */
+void publish_state(const Drone *drn, const DroneForces *f) {
+    DroneSnapshot snap;
+    snap.drone = *drn;
+    snap.repFx = f->repFx;         snap.repFy = f->repFy;
+    snap.repWallFx = f->repWallFx; snap.repWallFy = f->repWallFy;
+    snap.abtrFx = f->abtrFx;       snap.abtrFy = f->abtrFy;
+    drone_shm_publish(state_shm, &snap);
+}
+
+/* * Publishes every swarm position in a single message: header with the count,
+ * followed by 2 * count floats (x, y interleaved).
+ */
+void send_swarm(int fd_out) {
+    static float *buf = NULL;
+    static int buf_count = 0;
+    if (buf_count < swarm.count) {
+        float *tmp = realloc(buf, sizeof(float) * 2 * swarm.count);
+        if (!tmp) return;
+        buf = tmp;
+        buf_count = swarm.count;
+    }
+    swarm_positions(&swarm, buf);
+
+    Message msg;
+    msg_init(&msg, MSG_TYPE_SWARM);
+    msg.data.array.count = swarm.count;
+    frame_send(fd_out, &msg, buf, sizeof(float) * 2 * swarm.count);
+}
+
+/* * World updates are versioned: a snapshot sets the version, each delta must be
+ * exactly the next one. On a gap the deltas are ignored and full snapshots of
+ * both sets are requested, then the stream resumes from their versions.
+ */
+#define RESYNC_OBSTACLES 1
+#define RESYNC_TARGETS   2
+
+void world_snapshot_applied(int which, uint32_t version) {
+    world_version = version;
+    resync_wait &= ~which;
+}
+
+void handle_world_delta(const MsgDelta *d, int fd_out) {
+    if (resync_wait) return;   // Stale deltas still in the pipe before the snapshots
+
+    if (d->version != world_version + 1 || world_apply_delta(&world, d) < 0) {
+        logMessage(LOG_PATH, "[DRONE] World delta %u lost sync (at %u), requesting snapshots",
+                   d->version, world_version);
+        resync_wait = RESYNC_OBSTACLES | RESYNC_TARGETS;
+        Message msg;
+        msg_init(&msg, MSG_TYPE_RESYNC);
+        frame_send(fd_out, &msg, NULL, 0);
+        return;
+    }
+    world_version = d->version;
 }
 
 long get_time_diff_ns(struct timespec t1, struct timespec t2) {
@@ -102,13 +181,20 @@ int main(int argc, char *argv[]) {
     int fd_out  = atoi(argv[2]);
     int mode    = atoi(argv[3]);
     int role    = atoi(argv[4]);
+    if (argc > 5 && strcmp(argv[5], "-") != 0) state_shm = drone_shm_open(argv[5], 1);
+    if (argc > 6) {
+        int fds[2] = { fd_in, fd_out };
+        if (ring_attach(argv[6], fds, 2) == 0) logMessage(LOG_PATH, "[DRONE] Shared-memory rings: %s", argv[6]);
+    }
 
     signal(SIGPIPE, SIG_IGN); 
     fcntl(fd_in, F_SETFL, O_NONBLOCK);
 
     Drone drn = {0};
     Message msg;
-    int win_width = 0, win_height = 0;
+    FrameReader rx = {0};
+    const void *payload;
+    size_t payload_len;
     bool spawned = false;
 
     // Watchdog Setup
@@ -134,12 +220,38 @@ int main(int argc, char *argv[]) {
         wait_for_watchdog_pid();
     }
 
-    struct timespec last_render_time;
+    force_kernel_init();
+    world_load_params(&world);
+
+    int swarm_size = param_int("DRONE_SWARM_SIZE", 0);
+    if (swarm_size > 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        int threads = param_int("DRONE_SWARM_THREADS", cpus > 0 ? (int)cpus : 1);
+        if (swarm_init(&swarm, swarm_size, threads) < 0) exit(1);
+        if (world.adaptive_step) {
+            world.adaptive_step = false;
+            logMessage(LOG_PATH, "[DRONE] Adaptive step disabled in swarm mode (fixed batch step)");
+        }
+    }
+
+    struct timespec last_render_time, last_stats_time;
     clock_gettime(CLOCK_MONOTONIC, &last_render_time);
+    last_stats_time = last_render_time;
+
+    DroneForces frc = {0};
+    int owed_steps = 0, stride = 1;
+    StepScheduler sched;
+    sched_init(&sched, PHYSICS_DT_NS);
 
     // --- MAIN SIMULATION LOOP ---
     while (1) {
         
+        // ====================================================================
+        // STEP 0: WAIT FOR THE NEXT TICK (absolute deadline, no drift)
+        // ====================================================================
+        current_state = STATE_IDLE;
+        int steps = sched_wait(&sched);
+
         // ====================================================================
         // STEP 1: INPUT FLUSHING (Drain the pipe)
         // Legge TUTTI i messaggi disponibili. Se la blackboard manda 10 messaggi,
@@ -148,152 +260,109 @@ int main(int argc, char *argv[]) {
         current_state = STATE_PROCESSING_INPUT;
         
         while(1) {
-            ssize_t n = read(fd_in, &msg, sizeof(Message));
-            if (n < 0) {
-                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
-                if (errno == EINTR) continue;
-                break;
-            }
-            if (n == 0) break;
+            ssize_t n = frame_fill(&rx, fd_in);
+            if (n <= 0) break;   // EAGAIN: pipe drained, 0: blackboard gone
+
+            // Every complete frame in the buffer; a partial one waits for the next read
+            while (frame_next(&rx, &msg, &payload, &payload_len)) {
+                if (!msg_valid(&msg)) {
+                    logMessage(LOG_PATH, "[DRONE] Dropped message with version %d", msg.version);
+                    continue;
+                }
 
-            // Handle Message
-            switch (msg.type) {
-                case MSG_TYPE_SIZE: {
-                    sscanf(msg.data, "%d %d", &win_width, &win_height);
+                // Handle Message
+                switch (msg.type) {
+                    case MSG_TYPE_SIZE: {
+                        world_resize(&world, msg.data.size.width, msg.data.size.height);
 
-                    if (!spawned) {
+                        if (!spawned) {
                         
-                        // A. Spawn
-                        if (mode == MODE_STANDALONE) {
-                            drn.x = win_width / 2.0f;
-                            drn.y = win_height / 2.0f;
-                        } 
-                        else if (mode == MODE_NETWORKED) {
-                            if (role == MODE_SERVER) {
-                                drn.x = 5.0f; drn.y = 5.0f;
+                            // A. Spawn
+                            if (mode == MODE_STANDALONE) {
+                                drn.x = world.win_width / 2.0f;
+                                drn.y = world.win_height / 2.0f;
                             } 
-                            else if (role == MODE_CLIENT) {
-                                drn.x = (float)win_width - 5.0f;
-                                drn.y = (float)win_height - 5.0f;
+                            else if (mode == MODE_NETWORKED) {
+                                if (role == MODE_SERVER) {
+                                    drn.x = 5.0f; drn.y = 5.0f;
+                                } 
+                                else if (role == MODE_CLIENT) {
+                                    drn.x = (float)world.win_width - 5.0f;
+                                    drn.y = (float)world.win_height - 5.0f;
+                                }
                             }
-                        }
 
-                        drn.x_1 = drn.x_2 = drn.x;
-                        drn.y_1 = drn.y_2 = drn.y;
-                        drn.Fx = drn.Fy = 0.0f;
+                            if (swarm.count > 0) swarm_spawn(&swarm, drn.x, drn.y, world.win_width, world.win_height);
+
+                            drone_reset(&drn, drn.x, drn.y);
                         
-                        spawned = true;
+                            spawned = true;
                         
-                        // B. Sends initial position
-                        send_position(msg, drn.x, drn.y, fd_out);
-                        logMessage(LOG_PATH, "[DRONE] Spawned at %.2f %.2f", drn.x, drn.y);
+                            // B. Sends initial position
+                            if (state_shm) publish_state(&drn, &frc);
+                            else send_position(drn.x, drn.y, fd_out);
+                            logMessage(LOG_PATH, "[DRONE] Spawned at %.2f %.2f", drn.x, drn.y);
+                        }
+                        break;
                     }
-                    break;
-                }
-                case MSG_TYPE_INPUT: {
-                    char ch = msg.data[0];
-                    if(ch == 'q') goto quit;
-                    // Apply Forces
-                    switch(ch){
-                        case 'e':  drn.Fy -= 1.0f; break;
-                        case 'r':  drn.Fx += 1.0f; drn.Fy -= 1.0f; break;
-                        case 'f':  drn.Fx += 1.0f; break;
-                        case 'v':  drn.Fx += 1.0f; drn.Fy += 1.0f; break;
-                        case 'c':  drn.Fy += 1.0f; break;
-                        case 'x':  drn.Fx -= 1.0f; drn.Fy += 1.0f; break;
-                        case 's':  drn.Fx -= 1.0f; break;
-                        case 'w':  drn.Fx -= 1.0f; drn.Fy -= 1.0f; break;
-                        case 'd': // Brake
-                            drn.Fx *= 0.5f; drn.Fy *= 0.5f;
-                            if(fabs(drn.Fx) <= 0.5f) drn.Fx = 0.0f;
-                            if(fabs(drn.Fy) <= 0.5f) drn.Fy = 0.0f;
-                            break;
+                    case MSG_TYPE_INPUT: {
+                        char ch = msg.data.input.key;
+                        if(ch == 'q') goto quit;
+                        // Apply Forces
+                        drone_apply_key(&drn, ch);
+                        break;
+                    }
+                    case MSG_TYPE_OBSTACLES: { 
+                        int count = msg.data.array.count;
+                        if (count < 0 || payload_len != sizeof(Point) * (size_t)count) break;
+                        Point *obstacles = count ? malloc(sizeof(Point)*count) : NULL; 
+                        if (obstacles) memcpy(obstacles, payload, sizeof(Point)*count);
+                        world_set_obstacles(&world, obstacles, count);
+                        world_snapshot_applied(RESYNC_OBSTACLES, msg.data.array.version);
+                        break; 
+                    }
+                    case MSG_TYPE_TARGETS: { 
+                        int count = msg.data.array.count;
+                        if (count < 0 || payload_len != sizeof(Point) * (size_t)count) break;
+                        Point *targets = count ? malloc(sizeof(Point)*count) : NULL; 
+                        if (targets) memcpy(targets, payload, sizeof(Point)*count);
+                        world_set_targets(&world, targets, count);
+                        world_snapshot_applied(RESYNC_TARGETS, msg.data.array.version);
+                        break; 
+                    }
+                    case MSG_TYPE_WORLD_DELTA:
+                        handle_world_delta(&msg.data.delta, fd_out);
+                        break;
+                    case MSG_TYPE_EXIT: {
+                        logMessage(LOG_PATH, "[DRONE] Received EXIT signal. Shutting down.");
+                        goto quit;
                     }
-                    break;
-                }
-                case MSG_TYPE_OBSTACLES: { 
-                    int count; sscanf(msg.data, "%d", &count); 
-                    free(obstacles); obstacles = count ? malloc(sizeof(Point)*count) : NULL; 
-                    if (obstacles) read(fd_in, obstacles, sizeof(Point)*count);
-                    num_obstacles = count; 
-                    break; 
-                }
-                case MSG_TYPE_TARGETS: { 
-                    int count; sscanf(msg.data, "%d", &count); 
-                    free(targets); targets = count ? malloc(sizeof(Point)*count) : NULL; 
-                    if (targets) read(fd_in, targets, sizeof(Point)*count);
-                    num_targets = count; 
-                    break; 
-                }
-                case MSG_TYPE_EXIT: {
-                    logMessage(LOG_PATH, "[DRONE] Received EXIT signal. Shutting down.");
-                    goto quit;
                 }
             }
         }
 
         // ====================================================================
-        // STEP 2: PHYSICS CALCULATION (Run every cycle)
+        // STEP 2: PHYSICS CALCULATION (as many fixed steps as the clock owes us)
         // ====================================================================
+        // With the adaptive step, `stride` base steps are merged into one larger step.
         current_state = STATE_CALCULATING_PHYSICS;
-        float repFx=0.0f, repFy=0.0f, repWallFx=0.0f, repWallFy=0.0f, abtrFx = 0.0f, abtrFy = 0.0f;        
-        
-        // A. Attractive (Targets)
-        for(int i=0; i<num_targets; i++){
-            float dx = drn.x - ((float)targets[i].x + 0.5);
-            float dy = drn.y - ((float)targets[i].y + 0.5);
-            float d = sqrt(dx*dx + dy*dy) - 0.5f;
-            if(d < rho && d > 0.1f){
-                float F = eta * (1.0f/d - 1.0f/rho) / (d*d);
-                abtrFx += F * dx/d; abtrFy += F * dy/d;
-            }
-        }
-
-        // B. Repulsive (Obstacles)
-        for(int i=0; i<num_obstacles; i++){
-            float dx = drn.x - ((float)obstacles[i].x + 0.5);
-            float dy = drn.y - ((float)obstacles[i].y + 0.5);
-            float d = sqrt(dx*dx + dy*dy) - 0.5f;
-            if(d < rho && d > 0.1f){
-                float F = eta * (1.0f/d - 1.0f/rho) / (d*d);
-                repFx += F * dx/d; repFy += F * dy/d;
+        if (swarm.count > 0) {
+            SwarmCtx sctx = { &world, drn.Fx, drn.Fy, &frc };
+            for (int i = 0; i < steps; i++) swarm_step(&swarm, swarm_drone_step, &sctx);
+            world_collect_evals(&world, swarm.scratch, swarm.threads);
+            drn.x = swarm.x[0];
+            drn.y = swarm.y[0];
+        } else {
+            owed_steps += steps;
+            while (owed_steps >= stride) {
+                physics_step(&world, &drn, &frc, stride * DT, &main_scratch);
+                owed_steps -= stride;
+                stride = choose_stride(&world, &frc);
             }
+            world_collect_evals(&world, &main_scratch, 1);
         }
 
-        // C. Walls
-        float dR = (win_width-1) - drn.x;
-        float dL = drn.x - 1;
-        float dT = drn.y - 1;
-        float dB = (win_height-1) - drn.y;
-        if(dR < rho) repWallFx -= eta * (1.0f/dR - 1.0f/rho)/(dR*dR);
-        if(dL < rho) repWallFx += eta * (1.0f/dL - 1.0f/rho)/(dL*dL);
-        if(dT < rho) repWallFy += eta * (1.0f/dT - 1.0f/rho)/(dT*dT);
-        if(dB < rho) repWallFy -= eta * (1.0f/dB - 1.0f/rho)/(dB*dB);
-
-        // D. Sum & Clamp
-        float totFx = drn.Fx + repFx + repWallFx - abtrFx;
-        float totFy = drn.Fy + repFy + repWallFy - abtrFy;
-        float forceMag = sqrt(totFx*totFx + totFy*totFy);
-        if(forceMag > MAX_FORCE){
-            totFx = totFx/forceMag*MAX_FORCE;
-            totFy = totFy/forceMag*MAX_FORCE;
-        }
-
-        // E. Euler Integration
-        drn.x_2 = drn.x_1; drn.x_1 = drn.x;
-        drn.y_2 = drn.y_1; drn.y_1 = drn.y;
-        drn.x = (DT*DT*totFx - drn.x_2 + (2+K*DT)*drn.x_1)/(1+K*DT);
-        drn.y = (DT*DT*totFy - drn.y_2 + (2+K*DT)*drn.y_1)/(1+K*DT);
-
-        // F. Collision
-        for(int i=0; i<num_obstacles; i++){
-            float dx = drn.x - (float)obstacles[i].x;
-            float dy = drn.y - (float)obstacles[i].y;
-            if(sqrt(dx*dx + dy*dy) <= 0.1f){
-                drn.x = drn.x_1; drn.y = drn.y_1;
-                break;
-            }
-        }
+        if (state_shm && spawned) publish_state(&drn, &frc);
 
         // ====================================================================
         // STEP 3: OUTPUT THROTTLING (Send only at ~30 FPS)
@@ -303,17 +372,32 @@ int main(int argc, char *argv[]) {
         
         if (get_time_diff_ns(last_render_time, now) >= RENDER_DT_NS) {
             current_state = STATE_SENDING_OUTPUT;
-            send_position(msg, drn.x, drn.y, fd_out);
-            send_forces(msg, fd_out, drn.Fx, drn.Fy, repFx, repFy, repWallFx, repWallFy, abtrFx, abtrFy);
+            // With the shared state only the swarm array still goes through the pipe
+            if (swarm.count > 0) send_swarm(fd_out);
+            else if (!state_shm) send_position(drn.x, drn.y, fd_out);
+            if (!state_shm) {
+                send_forces(fd_out, drn.Fx, drn.Fy, frc.repFx, frc.repFy,
+                            frc.repWallFx, frc.repWallFy, frc.abtrFx, frc.abtrFy);
+            }
             last_render_time = now;
         }
 
-        usleep(1000); 
+        if (get_time_diff_ns(last_stats_time, now) >= SCHED_STATS_PERIOD_NS) {
+            sched_log_stats(&sched, "[DRONE][SCHED]");
+            logMessage(LOG_PATH, "[DRONE] %lu force evaluations (%s)", world.evals, integrator_name(world.integrator));
+            last_stats_time = now;
+        }
     }
 
 quit:
-    free(obstacles);
-    free(targets);
+    sched_log_stats(&sched, "[DRONE][SCHED]");
+    logMessage(LOG_PATH, "[DRONE] %lu force evaluations (%s)", world.evals, integrator_name(world.integrator));
+    swarm_free(&swarm);
+    grid_hits_free(&main_scratch.hits);
+    soa_free(&main_scratch.soa);
+    world_free(&world);
+    drone_shm_close(state_shm);
+    frame_reader_free(&rx);
     close(fd_in);
     close(fd_out);
     return 0;
@@ -0,0 +1,281 @@
+#include "drone_physics.h"
+#include "force_kernel.h"
+#include "params.h"
+#include "log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+void world_load_params(PhysicsWorld *w) {
+    w->use_field = param_int("DRONE_FORCE_FIELD", 0) != 0;
+    logMessage(LOG_PATH, "[DRONE] Obstacle force mode: %s", w->use_field ? "precomputed field" : "direct sum");
+    char integ_name[32];
+    w->integrator = integrator_from_name(param_str("DRONE_INTEGRATOR", "euler2", integ_name, sizeof(integ_name)));
+    w->adaptive_step = param_int("DRONE_ADAPTIVE_STEP", 0) != 0;
+    logMessage(LOG_PATH, "[DRONE] Integrator: %s, adaptive step: %s",
+               integrator_name(w->integrator), w->adaptive_step ? "on" : "off");
+}
+
+void world_resize(PhysicsWorld *w, int width, int height) {
+    w->win_width = width;
+    w->win_height = height;
+
+    if (bitmap_resize(&w->obst_bitmap, width, height) == 0) {
+        bitmap_fill(&w->obst_bitmap, w->obstacles, w->num_obstacles);
+    }
+
+    if (!w->use_field) return;
+    if (field_resize(&w->obst_field, width, height) == 0) {
+        field_rebuild(&w->obst_field, &w->obst_grid, w->obstacles);
+        w->field_valid = true;
+    } else {
+        // Still sized for the old window: fall back to the direct sum
+        logMessage(LOG_PATH, "[DRONE] ERROR allocating the force field for %dx%d", width, height);
+        w->field_valid = false;
+    }
+}
+
+/* * Brings the precomputed obstacle field up to date after a new obstacle array
+ * (already indexed by obst_grid) replaced `old`. When only a few entries moved,
+ * just their old and new rho-radius patches are recomputed.
+ */
+static void update_obstacle_field(PhysicsWorld *w, const Point *old, int old_count) {
+    if (!w->use_field || !w->obst_field.fx || w->obst_field.w != w->win_width * FIELD_SUBDIV) return;
+
+    if (!w->field_valid || old_count != w->num_obstacles) {
+        field_rebuild(&w->obst_field, &w->obst_grid, w->obstacles);
+        w->field_valid = true;
+        return;
+    }
+    for (int i = 0; i < w->num_obstacles; i++) {
+        if (old[i].x != w->obstacles[i].x || old[i].y != w->obstacles[i].y) {
+            field_update_cell(&w->obst_field, &w->obst_grid, w->obstacles, old[i]);
+            field_update_cell(&w->obst_field, &w->obst_grid, w->obstacles, w->obstacles[i]);
+        }
+    }
+}
+
+void world_set_obstacles(PhysicsWorld *w, Point *obstacles, int count) {
+    Point *old = w->obstacles;
+    int old_count = w->num_obstacles;
+    w->obstacles = obstacles;
+    w->num_obstacles = w->obst_cap = obstacles ? count : 0;
+    grid_build(&w->obst_grid, w->obstacles, w->num_obstacles, rho);
+    bitmap_fill(&w->obst_bitmap, w->obstacles, w->num_obstacles);
+    update_obstacle_field(w, old, old_count);
+    free(old);
+}
+
+void world_set_targets(PhysicsWorld *w, Point *targets, int count) {
+    free(w->targets);
+    w->targets = targets;
+    w->num_targets = w->targ_cap = targets ? count : 0;
+    grid_build(&w->targ_grid, w->targets, w->num_targets, rho);
+}
+
+/* * Edits one entry of a point set in place, found through the grid by its
+ * position; *old receives the position that was removed or moved away from.
+ * A removal moves the last entry into the gap and an addition appends, so
+ * every delta only touches the grid buckets involved.
+ */
+static int apply_to_set(Point **arr, int *count, int *cap, SpatialGrid *g, const MsgDelta *d, Point *old) {
+    Point p = { d->x, d->y };
+    *old = (Point){ d->from_x, d->from_y };
+    int i = d->op == DELTA_ADD ? *count : grid_point_at(g, *old);
+    if (i < 0) return -1;
+    switch (d->op) {
+        case DELTA_MOVE:
+            (*arr)[i] = p;
+            grid_move(g, i, *old);
+            return 0;
+        case DELTA_ADD:
+            if (*count == *cap) {
+                int n = *cap > 0 ? *cap * 2 : 16;
+                Point *tmp = realloc(*arr, sizeof(Point) * n);
+                if (!tmp) return -1;
+                *arr = tmp;
+                *cap = n;
+            }
+            (*arr)[(*count)++] = p;
+            if (g->num_points == 0) grid_build(g, *arr, *count, rho);   // First point: sizes the grid
+            else grid_add(g, *arr);
+            return 0;
+        case DELTA_REMOVE:
+            (*arr)[i] = (*arr)[--(*count)];
+            grid_remove(g, i, *old);
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+/* 1 if an obstacle lies on p (remote drones in networked mode can share a cell) */
+static int obstacle_on(const PhysicsWorld *w, Point p) {
+    return grid_point_at(&w->obst_grid, p) >= 0;
+}
+
+int world_apply_delta(PhysicsWorld *w, const MsgDelta *d) {
+    Point old = { 0, 0 };
+    if (d->entity == ENTITY_TARGET) {
+        return apply_to_set(&w->targets, &w->num_targets, &w->targ_cap, &w->targ_grid, d, &old);
+    }
+    if (d->entity != ENTITY_OBSTACLE) return -1;
+    if (apply_to_set(&w->obstacles, &w->num_obstacles, &w->obst_cap, &w->obst_grid, d, &old) < 0) return -1;
+
+    // The old bit stays set while another obstacle (a stacked remote drone) is still there
+    Point p = { d->x, d->y };
+    if (d->op != DELTA_ADD && !obstacle_on(w, old)) bitmap_reset(&w->obst_bitmap, old.x, old.y);
+    if (d->op != DELTA_REMOVE) bitmap_set(&w->obst_bitmap, p.x, p.y);
+
+    if (w->field_valid) {
+        if (d->op != DELTA_ADD) field_update_cell(&w->obst_field, &w->obst_grid, w->obstacles, old);
+        if (d->op != DELTA_REMOVE) field_update_cell(&w->obst_field, &w->obst_grid, w->obstacles, p);
+    }
+    return 0;
+}
+
+void world_collect_evals(PhysicsWorld *w, WorkerScratch *sc, int n) {
+    for (int i = 0; i < n; i++) {
+        w->evals += sc[i].evals;
+        sc[i].evals = 0;
+    }
+}
+
+void world_free(PhysicsWorld *w) {
+    grid_free(&w->obst_grid);
+    grid_free(&w->targ_grid);
+    bitmap_free(&w->obst_bitmap);
+    field_free(&w->obst_field);
+    free(w->obstacles);
+    free(w->targets);
+    memset(w, 0, sizeof(*w));
+}
+
+void drone_reset(Drone *drn, float x, float y) {
+    drn->x = drn->x_1 = drn->x_2 = x;
+    drn->y = drn->y_1 = drn->y_2 = y;
+    drn->vx = drn->vy = 0.0f;
+    drn->Fx = drn->Fy = 0.0f;
+}
+
+void drone_apply_key(Drone *drn, char ch) {
+    switch(ch){
+        case 'e':  drn->Fy -= 1.0f; break;
+        case 'r':  drn->Fx += 1.0f; drn->Fy -= 1.0f; break;
+        case 'f':  drn->Fx += 1.0f; break;
+        case 'v':  drn->Fx += 1.0f; drn->Fy += 1.0f; break;
+        case 'c':  drn->Fy += 1.0f; break;
+        case 'x':  drn->Fx -= 1.0f; drn->Fy += 1.0f; break;
+        case 's':  drn->Fx -= 1.0f; break;
+        case 'w':  drn->Fx -= 1.0f; drn->Fy -= 1.0f; break;
+        case 'd': // Brake
+            drn->Fx *= 0.5f; drn->Fy *= 0.5f;
+            if(fabs(drn->Fx) <= 0.5f) drn->Fx = 0.0f;
+            if(fabs(drn->Fy) <= 0.5f) drn->Fy = 0.0f;
+            break;
+    }
+}
+
+void environment_forces(const PhysicsWorld *w, float x, float y, WorkerScratch *sc, DroneForces *f) {
+    float repFx=0.0f, repFy=0.0f, repWallFx=0.0f, repWallFy=0.0f, abtrFx = 0.0f, abtrFy = 0.0f;
+
+    // Only the grid cells overlapping the influence radius are visited;
+    // the candidates are packed into SoA buffers for the vectorized kernel
+    int n_near;
+
+    // A. Attractive (Targets)
+    n_near = grid_query(&w->targ_grid, x, y, INFLUENCE_RADIUS, &sc->hits);
+    soa_gather(&sc->soa, w->targets, sc->hits.idx, n_near);
+    force_accumulate(sc->soa.x, sc->soa.y, sc->soa.count, x, y, &abtrFx, &abtrFy);
+
+    // B. Repulsive (Obstacles): O(1) field lookup when the cached field is enabled
+    if (w->field_valid) {
+        field_sample(&w->obst_field, x, y, &repFx, &repFy);
+    } else {
+        n_near = grid_query(&w->obst_grid, x, y, INFLUENCE_RADIUS, &sc->hits);
+        soa_gather(&sc->soa, w->obstacles, sc->hits.idx, n_near);
+        force_accumulate(sc->soa.x, sc->soa.y, sc->soa.count, x, y, &repFx, &repFy);
+    }
+
+    // C. Walls
+    float dR = (w->win_width-1) - x;
+    float dL = x - 1;
+    float dT = y - 1;
+    float dB = (w->win_height-1) - y;
+    if(dR < rho) repWallFx -= eta * (1.0f/dR - 1.0f/rho)/(dR*dR);
+    if(dL < rho) repWallFx += eta * (1.0f/dL - 1.0f/rho)/(dL*dL);
+    if(dT < rho) repWallFy += eta * (1.0f/dT - 1.0f/rho)/(dT*dT);
+    if(dB < rho) repWallFy -= eta * (1.0f/dB - 1.0f/rho)/(dB*dB);
+
+    f->repFx = repFx; f->repFy = repFy;
+    f->repWallFx = repWallFx; f->repWallFy = repWallFy;
+    f->abtrFx = abtrFx; f->abtrFy = abtrFy;
+}
+
+/* Context handed to the integrator's force callback */
+typedef struct {
+    const PhysicsWorld *world;
+    const Drone *drn;
+    WorkerScratch *sc;
+    DroneForces *first;   // Breakdown of the first evaluation (start of the step)
+    int evals;
+} ForceCtx;
+
+/* * D. Sum & Clamp: user force plus environment at (x, y), limited to MAX_FORCE. */
+static void total_force(void *ctx_ptr, float x, float y, float *fx, float *fy) {
+    ForceCtx *ctx = ctx_ptr;
+    DroneForces env, *f = (ctx->evals++ == 0) ? ctx->first : &env;
+    environment_forces(ctx->world, x, y, ctx->sc, f);
+
+    float totFx = ctx->drn->Fx + f->repFx + f->repWallFx - f->abtrFx;
+    float totFy = ctx->drn->Fy + f->repFy + f->repWallFy - f->abtrFy;
+    float forceMag = sqrt(totFx*totFx + totFy*totFy);
+    if(forceMag > MAX_FORCE){
+        totFx = totFx/forceMag*MAX_FORCE;
+        totFy = totFy/forceMag*MAX_FORCE;
+    }
+    *fx = totFx;
+    *fy = totFy;
+}
+
+void physics_step(PhysicsWorld *w, Drone *drn, DroneForces *f, float h, WorkerScratch *sc) {
+    // A-D. Forces + E. Integration
+    ForceCtx ctx = { w, drn, sc, f, 0 };
+    integrate_step(w->integrator, drn, h, total_force, &ctx);
+    sc->evals += ctx.evals;   // Per thread: a shared counter would bounce between the workers
+
+    // F. Collision: the only obstacle corner that can be within 0.1 is the
+    // nearest lattice point, so one bitmap lookup replaces the scan
+    int cx = (int)lroundf(drn->x);
+    int cy = (int)lroundf(drn->y);
+    if (bitmap_test(&w->obst_bitmap, cx, cy)) {
+        float dx = drn->x - (float)cx;
+        float dy = drn->y - (float)cy;
+        if(sqrtf(dx*dx + dy*dy) <= COLLISION_DIST){
+            drn->x = drn->x_1; drn->y = drn->y_1;
+            drn->vx = drn->vy = 0.0f;
+        }
+    }
+}
+
+/* * Far from obstacles, walls and targets the environment force is ~0 and the
+ * drone only feels the user force, so up to ADAPT_MAX_STRIDE steps are merged;
+ * near them the stride falls back to 1.
+ */
+int choose_stride(const PhysicsWorld *w, const DroneForces *f) {
+    if (!w->adaptive_step) return 1;
+    float ex = f->repFx + f->repWallFx - f->abtrFx;
+    float ey = f->repFy + f->repWallFy - f->abtrFy;
+    float mag = sqrtf(ex*ex + ey*ey);
+    int stride = ADAPT_MAX_STRIDE;
+    while (stride > 1 && mag * stride > ADAPT_FORCE_REF) stride /= 2;
+    return stride;
+}
+
+void swarm_drone_step(int i, Drone *drn, WorkerScratch *sc, void *ctx_ptr) {
+    SwarmCtx *ctx = ctx_ptr;
+    DroneForces f;
+    drn->Fx = ctx->Fx;
+    drn->Fy = ctx->Fy;
+    physics_step(ctx->world, drn, i == 0 ? ctx->lead_forces : &f, DT, sc);
+}
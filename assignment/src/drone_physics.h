@@ -0,0 +1,103 @@
+// drone_physics.h
+#ifndef DRONE_PHYSICS_H
+#define DRONE_PHYSICS_H
+
+#include <stdbool.h>
+#include "app_common.h"
+#include "spatial_grid.h"
+#include "potential_field.h"
+#include "occupancy_bitmap.h"
+#include "integrator.h"
+#include "swarm.h"
+
+// Search radii for the spatial index: entities are 1x1 cells centered at (x+0.5, y+0.5)
+#define INFLUENCE_RADIUS (rho + 0.5f)   // d = |p - c| - 0.5 < rho
+#define COLLISION_DIST 0.1f             // Collision when |p - (x,y)| <= 0.1 from the cell corner
+
+// Adaptive step (DRONE_ADAPTIVE_STEP): up to 8 base steps merged while |F_env| * stride <= 0.5
+#define ADAPT_MAX_STRIDE 8
+#define ADAPT_FORCE_REF  0.5f
+
+/* Force breakdown of the last physics step (sent to the blackboard status bar) */
+typedef struct {
+    float repFx, repFy;         // Obstacles
+    float repWallFx, repWallFy; // Borders
+    float abtrFx, abtrFy;       // Targets
+} DroneForces;
+
+/* * Everything the physics step reads: the window, the obstacle/target sets
+ * and their indexes, plus the options loaded from params.txt.
+ * Shared by the drone process and the headless bench (bench_drone.c).
+ */
+typedef struct {
+    int win_width, win_height;
+
+    Point *obstacles;            // Owned by the world
+    int num_obstacles, obst_cap; // Entries in use / allocated (deltas append in place)
+    Point *targets;
+    int num_targets, targ_cap;
+
+    SpatialGrid obst_grid;
+    SpatialGrid targ_grid;
+    OccupancyBitmap obst_bitmap; // Obstacle cells, for the O(1) collision test
+    ForceField obst_field;
+    bool use_field;              // DRONE_FORCE_FIELD in params.txt
+    bool field_valid;
+
+    IntegratorKind integrator;   // DRONE_INTEGRATOR in params.txt
+    bool adaptive_step;          // DRONE_ADAPTIVE_STEP in params.txt
+    unsigned long evals;         // Force evaluations (CPU cost indicator)
+} PhysicsWorld;
+
+// Reads DRONE_FORCE_FIELD, DRONE_INTEGRATOR and DRONE_ADAPTIVE_STEP from params.txt
+void world_load_params(PhysicsWorld *w);
+
+// New window size: resizes and refills the bitmap and the force field
+void world_resize(PhysicsWorld *w, int width, int height);
+
+// Replace the obstacle / target arrays (ownership moves to the world)
+void world_set_obstacles(PhysicsWorld *w, Point *obstacles, int count);
+void world_set_targets(PhysicsWorld *w, Point *targets, int count);
+
+/* * Applies one add/remove/move of a single obstacle or target: the arrays are
+ * edited in place and the grid, bitmap and field are patched locally instead
+ * of being rebuilt from a new array. Returns -1 if nothing lies where the delta
+ * says (the world is out of sync).
+ */
+int world_apply_delta(PhysicsWorld *w, const MsgDelta *d);
+
+void world_free(PhysicsWorld *w);
+
+// Puts the drone at rest in (x, y) with a clean history and no user force
+void drone_reset(Drone *drn, float x, float y);
+
+// Applies one keystroke of the input process (e r f v c x s w d) to the user force
+void drone_apply_key(Drone *drn, char ch);
+
+/* * Environment forces on (x, y): targets (A), obstacles (B) and walls (C).
+ * `sc` holds the query/kernel buffers of the calling thread.
+ */
+void environment_forces(const PhysicsWorld *w, float x, float y, WorkerScratch *sc, DroneForces *f);
+
+/* * One physics step of `h` seconds: forces, integration and collision.
+ * The force breakdown at the start of the step is stored in *f for the status bar.
+ */
+void physics_step(PhysicsWorld *w, Drone *drn, DroneForces *f, float h, WorkerScratch *sc);
+
+// Adds the force evaluations counted in n scratch buffers to w->evals (once their threads are idle)
+void world_collect_evals(PhysicsWorld *w, WorkerScratch *sc, int n);
+
+// Adaptive step: number of base steps (DT each) to merge into the next one
+int choose_stride(const PhysicsWorld *w, const DroneForces *f);
+
+/* Shared inputs of one batched swarm pass */
+typedef struct {
+    PhysicsWorld *world;
+    float Fx, Fy;                // User force, applied to every drone
+    DroneForces *lead_forces;    // Breakdown of drone 0, shown in the status bar
+} SwarmCtx;
+
+// SwarmStepFn for swarm_step(): one physics step of DT for drone i
+void swarm_drone_step(int i, Drone *drn, WorkerScratch *sc, void *ctx_ptr);
+
+#endif
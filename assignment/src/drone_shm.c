@@ -0,0 +1,64 @@
+#include "drone_shm.h"
+#include "log.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+int drone_shm_create(const char *name) {
+    int fd = shm_open(name, O_CREAT | O_RDWR | O_TRUNC, 0600);
+    if (fd < 0) {
+        logMessage(LOG_PATH, "[SHM] ERROR creating %s", name);
+        return -1;
+    }
+    // A fresh object is zero-filled: seq 0, frame 0 (nothing published yet)
+    int ret = ftruncate(fd, sizeof(DroneShm));
+    close(fd);
+    if (ret < 0) {
+        shm_unlink(name);
+        return -1;
+    }
+    return 0;
+}
+
+DroneShm* drone_shm_open(const char *name, int writable) {
+    int fd = shm_open(name, writable ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0) {
+        logMessage(LOG_PATH, "[SHM] ERROR opening %s", name);
+        return NULL;
+    }
+    void *p = mmap(NULL, sizeof(DroneShm), writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                   MAP_SHARED, fd, 0);
+    close(fd);
+    return p == MAP_FAILED ? NULL : p;
+}
+
+void drone_shm_close(DroneShm *shm) {
+    if (shm) munmap(shm, sizeof(DroneShm));
+}
+
+void drone_shm_publish(DroneShm *shm, DroneSnapshot *snap) {
+    uint32_t seq = __atomic_load_n(&shm->seq, __ATOMIC_RELAXED);
+    snap->frame = shm->snap.frame + 1;
+
+    __atomic_store_n(&shm->seq, seq + 1, __ATOMIC_RELAXED);   // Odd: write in progress
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    shm->snap = *snap;
+    __atomic_store_n(&shm->seq, seq + 2, __ATOMIC_RELEASE);   // Even: snapshot complete
+}
+
+int drone_shm_read(const DroneShm *shm, DroneSnapshot *out) {
+    for (int i = 0; i < DRONE_SHM_RETRIES; i++) {
+        uint32_t s1 = __atomic_load_n(&shm->seq, __ATOMIC_ACQUIRE);
+        if (s1 & 1u) {
+            sched_yield();
+            continue;
+        }
+        *out = shm->snap;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint32_t s2 = __atomic_load_n(&shm->seq, __ATOMIC_RELAXED);
+        if (s1 == s2) return 0;
+    }
+    return -1;
+}
@@ -0,0 +1,44 @@
+// drone_shm.h
+#ifndef DRONE_SHM_H
+#define DRONE_SHM_H
+
+#include <stdint.h>
+#include "app_common.h"
+
+#define DRONE_SHM_PREFIX   "/arp_drone_"   // Object name: prefix + pid of main
+#define DRONE_SHM_NAME_LEN 64
+#define DRONE_SHM_RETRIES  64              // Reader attempts before giving up on a snapshot
+
+/* Latest drone state, as published by the drone process */
+typedef struct {
+    uint64_t frame;             // Incremented at every publication
+    Drone drone;
+    float repFx, repFy;         // Obstacles
+    float repWallFx, repWallFy; // Borders
+    float abtrFx, abtrFy;       // Targets
+} DroneSnapshot;
+
+/* * Shared segment: a single-writer seqlock around the snapshot.
+ * `seq` is odd while the drone is writing; a reader retries until it sees
+ * the same even value before and after copying the data.
+ */
+typedef struct {
+    uint32_t seq;
+    DroneSnapshot snap;
+} DroneShm;
+
+// Creates (or truncates) the segment. Called once by main. Returns 0 on success.
+int drone_shm_create(const char *name);
+
+// Maps an existing segment, read-write for the drone, read-only for the blackboard
+DroneShm* drone_shm_open(const char *name, int writable);
+
+void drone_shm_close(DroneShm *shm);
+
+// Writer side: copies *snap into the segment (frame is set by the call)
+void drone_shm_publish(DroneShm *shm, DroneSnapshot *snap);
+
+// Reader side: consistent copy of the newest snapshot. Returns 0 on success.
+int drone_shm_read(const DroneShm *shm, DroneSnapshot *out);
+
+#endif
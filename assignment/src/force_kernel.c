@@ -0,0 +1,180 @@
+#include "force_kernel.h"
+#include "log.h"
+#include <stdlib.h>
+#include <math.h>
+
+#if defined(__x86_64__) || defined(__SSE2__)
+#define FK_X86 1
+#include <immintrin.h>
+#endif
+
+#define FK_MIN_DIST 0.1f
+#define FK_HALF_CELL 0.5f
+#define FK_TOLERANCE 1e-3f   // relative, vs the scalar reference
+
+typedef void (*ForceFn)(const float*, const float*, int, float, float, float*, float*);
+
+static ForceFn active_kernel = force_accumulate_scalar;
+static const char *active_name = "scalar";
+
+/* ======================================================================================
+ * SoA BUFFERS
+ * ====================================================================================== */
+int soa_gather(PointSoA *soa, const Point *points, const int *idx, int n) {
+    if (n > soa->cap) {
+        float *nx = realloc(soa->x, sizeof(float) * n);
+        if (!nx) return soa->count = 0;
+        soa->x = nx;
+        float *ny = realloc(soa->y, sizeof(float) * n);
+        if (!ny) return soa->count = 0;
+        soa->y = ny;
+        soa->cap = n;
+    }
+    for (int k = 0; k < n; k++) {
+        const Point *p = &points[idx ? idx[k] : k];
+        soa->x[k] = (float)p->x + FK_HALF_CELL;
+        soa->y[k] = (float)p->y + FK_HALF_CELL;
+    }
+    return soa->count = n;
+}
+
+void soa_free(PointSoA *soa) {
+    free(soa->x);
+    free(soa->y);
+    soa->x = soa->y = NULL;
+    soa->count = soa->cap = 0;
+}
+
+/* ======================================================================================
+ * KERNELS
+ * ====================================================================================== */
+void force_accumulate_scalar(const float *xs, const float *ys, int n,
+                             float px, float py, float *fx, float *fy) {
+    float sx = 0.0f, sy = 0.0f;
+    for (int i = 0; i < n; i++) {
+        float dx = px - xs[i];
+        float dy = py - ys[i];
+        float d = sqrtf(dx*dx + dy*dy) - FK_HALF_CELL;
+        if (d < rho && d > FK_MIN_DIST) {
+            float F = eta * (1.0f/d - 1.0f/rho) / (d*d);
+            sx += F * dx/d; sy += F * dy/d;
+        }
+    }
+    *fx += sx;
+    *fy += sy;
+}
+
+#ifdef FK_X86
+static void force_accumulate_sse2(const float *xs, const float *ys, int n,
+                                  float px, float py, float *fx, float *fy) {
+    const __m128 vpx  = _mm_set1_ps(px),  vpy = _mm_set1_ps(py);
+    const __m128 half = _mm_set1_ps(FK_HALF_CELL);
+    const __m128 vmin = _mm_set1_ps(FK_MIN_DIST), vrho = _mm_set1_ps(rho);
+    const __m128 irho = _mm_set1_ps(1.0f/rho),    veta = _mm_set1_ps(eta);
+    const __m128 one  = _mm_set1_ps(1.0f);
+    __m128 ax = _mm_setzero_ps(), ay = _mm_setzero_ps();
+
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 dx = _mm_sub_ps(vpx, _mm_loadu_ps(xs + i));
+        __m128 dy = _mm_sub_ps(vpy, _mm_loadu_ps(ys + i));
+        __m128 d  = _mm_sub_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy))), half);
+        __m128 in = _mm_and_ps(_mm_cmplt_ps(d, vrho), _mm_cmpgt_ps(d, vmin));
+
+        // F/d = eta * (1/d - 1/rho) / d^3, out-of-range lanes are masked to 0
+        __m128 id = _mm_div_ps(one, d);
+        __m128 fd = _mm_mul_ps(_mm_mul_ps(veta, _mm_sub_ps(id, irho)), _mm_mul_ps(id, _mm_mul_ps(id, id)));
+        fd = _mm_and_ps(fd, in);
+        ax = _mm_add_ps(ax, _mm_mul_ps(fd, dx));
+        ay = _mm_add_ps(ay, _mm_mul_ps(fd, dy));
+    }
+
+    float lx[4], ly[4];
+    _mm_storeu_ps(lx, ax);
+    _mm_storeu_ps(ly, ay);
+    *fx += (lx[0] + lx[1]) + (lx[2] + lx[3]);
+    *fy += (ly[0] + ly[1]) + (ly[2] + ly[3]);
+    force_accumulate_scalar(xs + i, ys + i, n - i, px, py, fx, fy);
+}
+
+__attribute__((target("avx2")))
+static void force_accumulate_avx2(const float *xs, const float *ys, int n,
+                                  float px, float py, float *fx, float *fy) {
+    const __m256 vpx  = _mm256_set1_ps(px),  vpy = _mm256_set1_ps(py);
+    const __m256 half = _mm256_set1_ps(FK_HALF_CELL);
+    const __m256 vmin = _mm256_set1_ps(FK_MIN_DIST), vrho = _mm256_set1_ps(rho);
+    const __m256 irho = _mm256_set1_ps(1.0f/rho),    veta = _mm256_set1_ps(eta);
+    const __m256 one  = _mm256_set1_ps(1.0f);
+    __m256 ax = _mm256_setzero_ps(), ay = _mm256_setzero_ps();
+
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 dx = _mm256_sub_ps(vpx, _mm256_loadu_ps(xs + i));
+        __m256 dy = _mm256_sub_ps(vpy, _mm256_loadu_ps(ys + i));
+        __m256 d  = _mm256_sub_ps(_mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy))), half);
+        __m256 in = _mm256_and_ps(_mm256_cmp_ps(d, vrho, _CMP_LT_OQ), _mm256_cmp_ps(d, vmin, _CMP_GT_OQ));
+
+        __m256 id = _mm256_div_ps(one, d);
+        __m256 fd = _mm256_mul_ps(_mm256_mul_ps(veta, _mm256_sub_ps(id, irho)), _mm256_mul_ps(id, _mm256_mul_ps(id, id)));
+        fd = _mm256_and_ps(fd, in);
+        ax = _mm256_add_ps(ax, _mm256_mul_ps(fd, dx));
+        ay = _mm256_add_ps(ay, _mm256_mul_ps(fd, dy));
+    }
+
+    float lx[8], ly[8];
+    _mm256_storeu_ps(lx, ax);
+    _mm256_storeu_ps(ly, ay);
+    for (int k = 0; k < 8; k++) { *fx += lx[k]; *fy += ly[k]; }
+    // Remaining 0..7 cells go through the SSE2 path (and its scalar tail)
+    force_accumulate_sse2(xs + i, ys + i, n - i, px, py, fx, fy);
+}
+#endif
+
+/* ======================================================================================
+ * DISPATCH
+ * ====================================================================================== */
+
+/* * Runs a candidate kernel on a synthetic ring of cells around the probe point
+ * and compares it with the scalar reference.
+ */
+static int kernel_matches_scalar(ForceFn fn) {
+    enum { N = 67 };   // not a multiple of the lane width, so tails are exercised
+    float xs[N], ys[N];
+    for (int i = 0; i < N; i++) {
+        float r = 0.3f + (rho + 0.5f) * (float)i / N;
+        xs[i] = 10.0f + r * cosf(0.7f * i);
+        ys[i] = 10.0f + r * sinf(0.7f * i);
+    }
+    float rx = 0.0f, ry = 0.0f, tx = 0.0f, ty = 0.0f;
+    force_accumulate_scalar(xs, ys, N, 10.0f, 10.0f, &rx, &ry);
+    fn(xs, ys, N, 10.0f, 10.0f, &tx, &ty);
+
+    float scale = fabsf(rx) + fabsf(ry) + 1.0f;
+    return fabsf(rx - tx) <= FK_TOLERANCE * scale && fabsf(ry - ty) <= FK_TOLERANCE * scale;
+}
+
+void force_kernel_init(void) {
+    active_kernel = force_accumulate_scalar;
+    active_name = "scalar";
+#ifdef FK_X86
+    if (kernel_matches_scalar(force_accumulate_sse2)) {
+        active_kernel = force_accumulate_sse2;
+        active_name = "sse2";
+    }
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && kernel_matches_scalar(force_accumulate_avx2)) {
+        active_kernel = force_accumulate_avx2;
+        active_name = "avx2";
+    }
+#endif
+    logMessage(LOG_PATH, "[FORCE] Using %s force kernel", active_name);
+}
+
+const char* force_kernel_name(void) {
+    return active_name;
+}
+
+void force_accumulate(const float *xs, const float *ys, int n,
+                      float px, float py, float *fx, float *fy) {
+    active_kernel(xs, ys, n, px, py, fx, fy);
+}
@@ -0,0 +1,40 @@
+// force_kernel.h
+#ifndef FORCE_KERNEL_H
+#define FORCE_KERNEL_H
+
+#include "app_common.h"
+
+/* * Structure-of-arrays copy of a set of cells.
+ * x[i], y[i] hold the CENTER of the cell (Point + 0.5), ready for the kernel.
+ */
+typedef struct {
+    float *x;
+    float *y;
+    int count;
+    int cap;
+} PointSoA;
+
+/* * Copies the points selected by `idx` (or all of them if idx == NULL)
+ * into the SoA buffers. Returns the number of points copied.
+ */
+int soa_gather(PointSoA *soa, const Point *points, const int *idx, int n);
+void soa_free(PointSoA *soa);
+
+/* * Picks the widest implementation the CPU supports (AVX2 > SSE2 > scalar)
+ * and checks it against the scalar reference before enabling it.
+ */
+void force_kernel_init(void);
+const char* force_kernel_name(void);
+
+/* * Latombe field of n cells on the point (px, py):
+ * for every cell with rho > d > 0.1, where d = |p - c| - 0.5,
+ * F = eta * (1/d - 1/rho) / d^2 along (p - c) / d is added to *fx, *fy.
+ */
+void force_accumulate(const float *xs, const float *ys, int n,
+                      float px, float py, float *fx, float *fy);
+
+// Plain C reference of force_accumulate()
+void force_accumulate_scalar(const float *xs, const float *ys, int n,
+                             float px, float py, float *fx, float *fy);
+
+#endif
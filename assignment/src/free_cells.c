@@ -0,0 +1,131 @@
+#include "free_cells.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* Open-addressing int -> int map; keys are cell or slot numbers, -1 marks a free entry */
+typedef struct {
+    int *keys;
+    int *vals;
+    int mask;
+    int shift;
+} CellMap;
+
+static int map_init(CellMap *m, int entries) {
+    int bits = 4;
+    while ((1 << bits) < 2 * entries) bits++;
+    int cap = 1 << bits;
+    m->keys = malloc(sizeof(int) * cap);
+    m->vals = malloc(sizeof(int) * cap);
+    if (!m->keys || !m->vals) return -1;
+    memset(m->keys, 0xff, sizeof(int) * cap);
+    m->mask = cap - 1;
+    m->shift = 32 - bits;
+    return 0;
+}
+
+static int map_find(const CellMap *m, int key) {
+    int i = (int)(((uint32_t)key * 2654435761u) >> m->shift);
+    while (m->keys[i] != -1 && m->keys[i] != key) i = (i + 1) & m->mask;
+    return i;
+}
+
+static int map_get(const CellMap *m, int key, int missing) {
+    int i = map_find(m, key);
+    return m->keys[i] == key ? m->vals[i] : missing;
+}
+
+static void map_put(CellMap *m, int key, int val) {
+    int i = map_find(m, key);
+    m->keys[i] = key;
+    m->vals[i] = val;
+}
+
+static void map_free(CellMap *m) {
+    free(m->keys);
+    free(m->vals);
+}
+
+/*
+ * The shuffled pool. Dense: `perm` holds every slot and `excluded` one byte per
+ * cell. Sparse: a slot missing from `moved` still holds its own cell number.
+ */
+typedef struct {
+    int sparse;
+    int *perm;
+    uint8_t *excluded;
+    CellMap moved, excl;
+} CellPool;
+
+static int pool_get(const CellPool *p, int slot) {
+    return p->sparse ? map_get(&p->moved, slot, slot) : p->perm[slot];
+}
+
+static void pool_set(CellPool *p, int slot, int cell) {
+    if (p->sparse) map_put(&p->moved, slot, cell);
+    else p->perm[slot] = cell;
+}
+
+static int pool_excluded(const CellPool *p, int cell) {
+    return p->sparse ? map_get(&p->excl, cell, 0) : p->excluded[cell];
+}
+
+static void pool_free(CellPool *p) {
+    free(p->perm);
+    free(p->excluded);
+    map_free(&p->moved);
+    map_free(&p->excl);
+}
+
+static int pool_init(CellPool *p, int cells, int draws, int cols, int rows, const Point *exclude, int num_exclude) {
+    if (p->sparse) {
+        if (map_init(&p->moved, draws) < 0 || map_init(&p->excl, num_exclude) < 0) return -1;
+    } else {
+        p->perm = malloc(sizeof(int) * cells);
+        p->excluded = calloc(cells, 1);
+        if (!p->perm || !p->excluded) return -1;
+        for (int i = 0; i < cells; i++) p->perm[i] = i;
+    }
+
+    // Points on the border or outside the window cannot be drawn anyway
+    for (int i = 0; i < num_exclude; i++) {
+        int x = exclude[i].x - 1, y = exclude[i].y - 1;
+        if (x < 0 || y < 0 || x >= cols || y >= rows) continue;
+        if (p->sparse) map_put(&p->excl, y * cols + x, 1);
+        else p->excluded[y * cols + x] = 1;
+    }
+    return 0;
+}
+
+int free_cells_pick(int width, int height, const Point *exclude, int num_exclude, Point *out, int count) {
+    int cols = width - 2, rows = height - 2;
+    if (cols <= 0 || rows <= 0 || count <= 0) return 0;
+    if (num_exclude < 0) num_exclude = 0;
+
+    int cells = cols * rows;
+    long draws = (long)count + num_exclude;     // Upper bound: every excluded cell comes out once
+    if (draws > cells) draws = cells;
+
+    CellPool p = {0};
+    p.sparse = draws * FREE_CELLS_SPARSE_RATIO < cells;
+    if (pool_init(&p, cells, (int)draws, cols, rows, exclude, num_exclude) < 0) {
+        pool_free(&p);
+        return -1;
+    }
+
+    // Partial Fisher-Yates: slot k gets a random cell among slots k..cells-1
+    int placed = 0;
+    for (int k = 0; k < cells && placed < count; k++) {
+        int j = k + rand() % (cells - k);
+        int cell = pool_get(&p, j);
+        pool_set(&p, j, pool_get(&p, k));
+        if (pool_excluded(&p, cell)) continue;
+
+        out[placed].x = cell % cols + 1;
+        out[placed].y = cell / cols + 1;
+        placed++;
+    }
+
+    pool_free(&p);
+    return placed;
+}
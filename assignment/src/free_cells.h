@@ -0,0 +1,24 @@
+// free_cells.h
+#ifndef FREE_CELLS_H
+#define FREE_CELLS_H
+
+#include "app_common.h"
+
+#define FREE_CELLS_SPARSE_RATIO 8   // Fewer than 1/8 of the cells drawn: hashed pool
+
+/* * Picks `count` distinct random cells strictly inside a width x height window
+ * (border excluded), none of them listed in `exclude`, with no retries.
+ *
+ * The interior cells are a pool shuffled lazily by a partial Fisher-Yates: draw k
+ * swaps a random remaining cell into slot k. An excluded cell that comes out is
+ * dropped, and since every cell comes out at most once the whole call takes at
+ * most count + num_exclude draws. The pool is a plain array when a good part of
+ * the window is drawn; otherwise only the swapped slots are kept, in a hash map,
+ * so huge sparse maps never allocate a per-cell array.
+ *
+ * Uses rand(). Returns the number of cells written to `out`, which is less than
+ * `count` only if the window has fewer free cells, or -1 if out of memory.
+ */
+int free_cells_pick(int width, int height, const Point *exclude, int num_exclude, Point *out, int count);
+
+#endif
@@ -15,8 +15,10 @@
 #include "process_pid.h"
 #include "app_common.h"
 #include "log.h"       
+#include "params.h"
 
 #define KEY_QUIT 'q'
+#define HEADLESS_TRACE_DEFAULT "bench/trace_default.txt"
 
 static volatile pid_t watchdog_pid = -1;
 
@@ -66,6 +68,66 @@ void watchdog_ping_handler(int signo) {
     if(watchdog_pid > 0) kill(watchdog_pid, SIGUSR2);
 }
 
+/* Sends one key to the blackboard. Returns 0 if the pipe is gone. */
+int send_key(int fd_out, int ch) {
+    Message msg;
+    msg_init(&msg, MSG_TYPE_INPUT);
+    msg.data.input.key = (char)ch;
+    return write(fd_out, &msg, sizeof(msg)) >= 0;
+}
+
+/* Sleeps until `ms` milliseconds after `start` (watchdog pings do not cut it short) */
+void sleep_until(const struct timespec *start, long ms) {
+    struct timespec t = *start;
+    t.tv_sec += ms / 1000;
+    t.tv_nsec += (ms % 1000) * 1000000L;
+    if (t.tv_nsec >= 1000000000L) {
+        t.tv_sec++;
+        t.tv_nsec -= 1000000000L;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) == EINTR);
+}
+
+/*
+ * Headless mode (HEADLESS 1 in params.txt): there is no terminal to read, so the
+ * keys come from HEADLESS_TRACE ("<ms> <key>" lines, the bench_drone format),
+ * replayed in real time HEADLESS_TRACE_REPEAT times. 'q' follows the last key,
+ * which shuts the whole system down.
+ */
+void replay_trace(int fd_out) {
+    char path[256], line[128];
+    param_str("HEADLESS_TRACE", HEADLESS_TRACE_DEFAULT, path, sizeof(path));
+    int repeat = param_int("HEADLESS_TRACE_REPEAT", 1);
+
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        logMessage(LOG_PATH, "[INPUT] ERROR opening trace %s, quitting", path);
+        send_key(fd_out, KEY_QUIT);
+        return;
+    }
+    logMessage(LOG_PATH, "[INPUT] Headless: replaying %s x%d", path, repeat);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    long offset_ms = 0, last_ms = 0, ms;
+    char key;
+    for (int r = 0; r < repeat; r++) {
+        rewind(fp);
+        while (fgets(line, sizeof(line), fp)) {
+            if (line[0] == '#' || sscanf(line, "%ld %c", &ms, &key) != 2) continue;
+            sleep_until(&start, offset_ms + ms);
+            if (!send_key(fd_out, key) || key == KEY_QUIT) {
+                fclose(fp);
+                return;
+            }
+            last_ms = ms;
+        }
+        offset_ms += last_ms;
+    }
+    fclose(fp);
+    send_key(fd_out, KEY_QUIT);
+}
+
 int main(int argc, char *argv[]) {
     if(argc < 3) return 1;
 
@@ -96,9 +158,14 @@ int main(int argc, char *argv[]) {
         // 3. ASPETTA IL WATCHDOG
         wait_for_watchdog_pid();
     }
+
+    if (param_int("HEADLESS", 0)) {
+        replay_trace(fd_out);
+        close(fd_out);
+        return 0;
+    }
     
     int ch;
-    char msg_buf[2];
 
     initscr();
     cbreak();
@@ -115,10 +182,7 @@ int main(int argc, char *argv[]) {
             continue;
         }
 
-        msg_buf[0] = (char)ch;
-        msg_buf[1] = '\0';
-
-        if(write(fd_out, msg_buf, 2) < 0) break;
+        if (!send_key(fd_out, ch)) break;
         mvprintw(14, 0, "Feedback: '%c'  ", ch);
         refresh();
 
@@ -0,0 +1,92 @@
+#include "integrator.h"
+#include <string.h>
+
+IntegratorKind integrator_from_name(const char *name) {
+    if (strcmp(name, "semi_implicit") == 0) return INTEG_SEMI_IMPLICIT;
+    if (strcmp(name, "verlet") == 0)        return INTEG_VERLET;
+    if (strcmp(name, "rk4") == 0)           return INTEG_RK4;
+    return INTEG_EULER2;
+}
+
+const char* integrator_name(IntegratorKind kind) {
+    switch (kind) {
+        case INTEG_SEMI_IMPLICIT: return "semi_implicit";
+        case INTEG_VERLET:        return "verlet";
+        case INTEG_RK4:           return "rk4";
+        default:                  return "euler2";
+    }
+}
+
+// Acceleration for the state (p, v)
+static void accel(TotalForceFn force, void *ctx, float x, float y, float vx, float vy,
+                  float *ax, float *ay) {
+    float fx, fy;
+    force(ctx, x, y, &fx, &fy);
+    *ax = (fx - K * vx) / M;
+    *ay = (fy - K * vy) / M;
+}
+
+void integrate_step(IntegratorKind kind, Drone *drn, float h, TotalForceFn force, void *ctx) {
+    float x = drn->x, y = drn->y;
+    float vx = drn->vx, vy = drn->vy;
+
+    switch (kind) {
+        case INTEG_SEMI_IMPLICIT: {
+            float ax, ay;
+            accel(force, ctx, x, y, vx, vy, &ax, &ay);
+            vx += h * ax;  vy += h * ay;
+            x  += h * vx;  y  += h * vy;
+            break;
+        }
+        case INTEG_VERLET: {
+            float ax, ay;
+            accel(force, ctx, x, y, vx, vy, &ax, &ay);
+            x += h * vx + 0.5f * h * h * ax;
+            y += h * vy + 0.5f * h * h * ay;
+            // Half-step velocity feeds the damping term of the second evaluation
+            float hvx = vx + 0.5f * h * ax, hvy = vy + 0.5f * h * ay;
+            float bx, by;
+            accel(force, ctx, x, y, hvx, hvy, &bx, &by);
+            vx = hvx + 0.5f * h * bx;
+            vy = hvy + 0.5f * h * by;
+            break;
+        }
+        case INTEG_RK4: {
+            float k1x, k1y, k2x, k2y, k3x, k3y, k4x, k4y;   // accelerations
+            float l1x = vx, l1y = vy;                        // velocities
+            accel(force, ctx, x, y, l1x, l1y, &k1x, &k1y);
+
+            float l2x = vx + 0.5f*h*k1x, l2y = vy + 0.5f*h*k1y;
+            accel(force, ctx, x + 0.5f*h*l1x, y + 0.5f*h*l1y, l2x, l2y, &k2x, &k2y);
+
+            float l3x = vx + 0.5f*h*k2x, l3y = vy + 0.5f*h*k2y;
+            accel(force, ctx, x + 0.5f*h*l2x, y + 0.5f*h*l2y, l3x, l3y, &k3x, &k3y);
+
+            float l4x = vx + h*k3x, l4y = vy + h*k3y;
+            accel(force, ctx, x + h*l3x, y + h*l3y, l4x, l4y, &k4x, &k4y);
+
+            x  += h / 6.0f * (l1x + 2*l2x + 2*l3x + l4x);
+            y  += h / 6.0f * (l1y + 2*l2y + 2*l3y + l4y);
+            vx += h / 6.0f * (k1x + 2*k2x + 2*k3x + k4x);
+            vy += h / 6.0f * (k1y + 2*k2y + 2*k3y + k4y);
+            break;
+        }
+        default: {
+            /* Original recurrence
+             *   x = (DT^2 F - x_2 + (2 + K DT) x_1) / (1 + K DT)
+             * is the same as  v' = (M v + h F) / (M + K h),  x' = x + h v'  with v = (x_1 - x_2)/h */
+            float fx, fy;
+            force(ctx, x, y, &fx, &fy);
+            vx = (M * vx + h * fx) / (M + K * h);
+            vy = (M * vy + h * fy) / (M + K * h);
+            x += h * vx;
+            y += h * vy;
+            break;
+        }
+    }
+
+    drn->x_2 = drn->x_1; drn->x_1 = drn->x;
+    drn->y_2 = drn->y_1; drn->y_1 = drn->y;
+    drn->x = x;   drn->y = y;
+    drn->vx = vx; drn->vy = vy;
+}
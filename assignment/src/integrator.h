@@ -0,0 +1,31 @@
+// integrator.h
+#ifndef INTEGRATOR_H
+#define INTEGRATOR_H
+
+#include "app_common.h"
+
+/* * Time integrators for the drone dynamics  M * a = F(p) - K * v.
+ * INTEG_EULER2 is the original two-step recurrence on x_1/x_2, written in
+ * velocity form (implicit damping) so it also accepts a variable step.
+ */
+typedef enum {
+    INTEG_EULER2,         // Original scheme (default)
+    INTEG_SEMI_IMPLICIT,  // Symplectic Euler: v first, then p with the new v
+    INTEG_VERLET,         // Velocity Verlet, 2 force evaluations per step
+    INTEG_RK4             // Classic Runge-Kutta 4, 4 force evaluations per step
+} IntegratorKind;
+
+/* * Total force (already clamped) acting on the drone at position (x, y).
+ * `ctx` is passed through untouched.
+ */
+typedef void (*TotalForceFn)(void *ctx, float x, float y, float *fx, float *fy);
+
+IntegratorKind integrator_from_name(const char *name);
+const char* integrator_name(IntegratorKind kind);
+
+/* * Advances drn by `h` seconds. x_1/y_1 receive the previous position
+ * (used to undo the step on collision) and x_2/y_2 the one before.
+ */
+void integrate_step(IntegratorKind kind, Drone *drn, float h, TotalForceFn force, void *ctx);
+
+#endif
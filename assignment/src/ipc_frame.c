@@ -0,0 +1,123 @@
+#include "ipc_frame.h"
+#include "ipc_ring.h"
+#include "log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+int frame_send(int fd, const Message *msg, const void *payload, size_t payload_len) {
+    uint32_t len = (uint32_t)(sizeof(Message) + payload_len);
+    struct iovec iov[3] = {
+        { &len, sizeof(len) },
+        { (void *)msg, sizeof(Message) },
+        { (void *)payload, payload_len },
+    };
+    struct iovec *v = iov;
+    int cnt = payload_len ? 3 : 2;
+
+    SpscRing *ring = ring_lookup(fd);
+    if (ring) return ring_write(ring, iov, cnt);
+
+    while (cnt > 0) {
+        ssize_t n = writev(fd, v, cnt);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                struct pollfd p = { fd, POLLOUT, 0 };
+                poll(&p, 1, -1);
+                continue;
+            }
+            return -1;
+        }
+        // Skip what was written and resume inside the partially written vector
+        while (cnt > 0 && (size_t)n >= v->iov_len) {
+            n -= v->iov_len;
+            v++;
+            cnt--;
+        }
+        if (cnt > 0) {
+            v->iov_base = (uint8_t *)v->iov_base + n;
+            v->iov_len -= n;
+        }
+    }
+    return 0;
+}
+
+/* Makes room for at least `need` more bytes after `end` */
+static int reserve(FrameReader *r, size_t need) {
+    if (r->start > 0) {
+        memmove(r->buf, r->buf + r->start, r->end - r->start);
+        r->end -= r->start;
+        r->start = 0;
+    }
+    if (r->cap - r->end >= need) return 0;
+    size_t cap = r->cap ? r->cap : FRAME_READ_CHUNK;
+    while (cap - r->end < need) cap *= 2;
+    uint8_t *tmp = realloc(r->buf, cap);
+    if (!tmp) return -1;
+    r->buf = tmp;
+    r->cap = cap;
+    return 0;
+}
+
+ssize_t frame_fill(FrameReader *r, int fd) {
+    // Room for the pending frame (if its length is known) or at least one chunk
+    size_t want = FRAME_READ_CHUNK;
+    size_t have = r->end - r->start;
+    if (have >= sizeof(uint32_t)) {
+        uint32_t len;
+        memcpy(&len, r->buf + r->start, sizeof(len));
+        if (len <= FRAME_MAX_LEN && sizeof(len) + len > have && sizeof(len) + len - have > want) {
+            want = sizeof(len) + len - have;
+        }
+    }
+    if (reserve(r, want) < 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+    ssize_t n;
+    SpscRing *ring = ring_lookup(fd);
+    if (ring) {
+        n = ring_read(ring, r->buf + r->end, r->cap - r->end);
+    } else {
+        do {
+            n = read(fd, r->buf + r->end, r->cap - r->end);
+        } while (n < 0 && errno == EINTR);
+    }
+    if (n > 0) r->end += n;
+    return n;
+}
+
+int frame_next(FrameReader *r, Message *msg, const void **payload, size_t *payload_len) {
+    size_t have = r->end - r->start;
+    if (have < sizeof(uint32_t)) return 0;
+
+    uint32_t len;
+    memcpy(&len, r->buf + r->start, sizeof(len));
+    if (len < sizeof(Message) || len > FRAME_MAX_LEN) {
+        logMessage(LOG_PATH, "[FRAME] Bad frame length %u, dropping %zu buffered bytes", len, have);
+        r->start = r->end = 0;
+        return 0;
+    }
+    if (have < sizeof(len) + len) return 0;
+
+    const uint8_t *body = r->buf + r->start + sizeof(len);
+    memcpy(msg, body, sizeof(Message));
+    *payload = body + sizeof(Message);
+    *payload_len = len - sizeof(Message);
+    r->start += sizeof(len) + len;
+    return 1;
+}
+
+void frame_reader_free(FrameReader *r) {
+    free(r->buf);
+    memset(r, 0, sizeof(*r));
+}
+
+void frame_wait_prepare(int fd) {
+    SpscRing *ring = ring_lookup(fd);
+    if (ring) ring_park(ring);
+}
@@ -0,0 +1,56 @@
+// ipc_frame.h
+#ifndef IPC_FRAME_H
+#define IPC_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "app_common.h"
+
+#define FRAME_MAX_LEN (16u * 1024u * 1024u)   // Upper bound of a frame body (sanity check)
+#define FRAME_READ_CHUNK 4096                  // Minimum free space for each read()
+
+/* * Wire layout of a frame: uint32_t length | Message | payload[length - sizeof(Message)]
+ * The payload carries the variable part (obstacle/target/swarm arrays), so one
+ * frame holds the whole update and the receiver never sees half an array.
+ */
+
+/* * Sends `msg` and `payload_len` bytes of payload as a single frame, gathered
+ * with writev() in one call (short writes and EINTR are resumed), or copied
+ * into the shared-memory ring bound to fd (ipc_ring.c).
+ * Returns 0 on success, -1 on error.
+ */
+int frame_send(int fd, const Message *msg, const void *payload, size_t payload_len);
+
+/* * Receiver side: bytes are accumulated until a whole frame is available.
+ * Partial reads (a frame split across several read() calls) are normal.
+ */
+typedef struct {
+    uint8_t *buf;
+    size_t cap;
+    size_t start;    // First unconsumed byte
+    size_t end;      // One past the last byte read
+} FrameReader;
+
+/* * One read() from fd into the reader (never more, so it does not block on a
+ * descriptor reported readable by select()). Returns the bytes read, 0 at EOF,
+ * -1 on error with errno set (EAGAIN on an empty non-blocking pipe or an empty
+ * ring; a ring has no EOF, its processes stop on MSG_TYPE_EXIT).
+ */
+ssize_t frame_fill(FrameReader *r, int fd);
+
+/* * Extracts the next complete frame, if any: copies the Message into *msg and
+ * points *payload at the payload bytes (valid until the next frame_fill()).
+ * Returns 1 when a frame was extracted, 0 when more bytes are needed.
+ * A corrupted length resets the reader and returns 0.
+ */
+int frame_next(FrameReader *r, Message *msg, const void **payload, size_t *payload_len);
+
+/* * Call right before select() on a descriptor read with frame_fill(). No-op on a
+ * pipe; on a shared-memory ring (IPC_SHM_RINGS) it arms the eventfd wakeup.
+ */
+void frame_wait_prepare(int fd);
+
+void frame_reader_free(FrameReader *r);
+
+#endif
@@ -0,0 +1,193 @@
+#include "ipc_ring.h"
+#include "app_common.h"
+#include "log.h"
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+
+/* Descriptors of this process bound to a ring (at most all the links) */
+static struct {
+    int fd;
+    SpscRing *ring;
+} bound[RING_LINKS];
+static int num_bound = 0;
+
+static RingShm* map_object(const char *name, int flags) {
+    int fd = shm_open(name, flags, 0600);
+    if (fd < 0) {
+        logMessage(LOG_PATH, "[RING] ERROR opening %s", name);
+        return NULL;
+    }
+    if ((flags & O_CREAT) && ftruncate(fd, sizeof(RingShm)) < 0) {
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+    void *p = mmap(NULL, sizeof(RingShm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return p == MAP_FAILED ? NULL : p;
+}
+
+int ring_shm_create(const char *name, int evfds[RING_LINKS]) {
+    // A fresh object is zero-filled: every ring empty, nobody parked
+    RingShm *shm = map_object(name, O_CREAT | O_RDWR | O_TRUNC);
+    if (!shm) return -1;
+
+    for (int i = 0; i < RING_LINKS; i++) {
+        evfds[i] = eventfd(0, EFD_NONBLOCK);
+        if (evfds[i] < 0) {
+            logMessage(LOG_PATH, "[RING] ERROR creating eventfd: %s", strerror(errno));
+            while (--i >= 0) close(evfds[i]);
+            munmap(shm, sizeof(RingShm));
+            shm_unlink(name);
+            return -1;
+        }
+        shm->rings[i].evfd = evfds[i];
+    }
+    // The children map their own view; main only needed to fill in the descriptors
+    munmap(shm, sizeof(RingShm));
+    return 0;
+}
+
+int ring_attach(const char *name, const int *fds, int n) {
+    RingShm *shm = map_object(name, O_RDWR);
+    if (!shm) return -1;
+
+    for (int k = 0; k < n; k++) {
+        for (int i = 0; i < RING_LINKS; i++) {
+            if (shm->rings[i].evfd == fds[k] && num_bound < RING_LINKS) {
+                bound[num_bound].fd = fds[k];
+                bound[num_bound].ring = &shm->rings[i];
+                num_bound++;
+                break;
+            }
+        }
+    }
+    return 0;
+}
+
+SpscRing* ring_lookup(int fd) {
+    for (int i = 0; i < num_bound; i++) {
+        if (bound[i].fd == fd) return bound[i].ring;
+    }
+    return NULL;
+}
+
+/* Wakes the consumer only if it announced it is going to sleep */
+static void notify(SpscRing *r) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);   // head store before the parked load
+    if (__atomic_load_n(&r->parked, __ATOMIC_RELAXED) &&
+        __atomic_exchange_n(&r->parked, 0, __ATOMIC_SEQ_CST)) {
+        uint64_t one = 1;
+        ssize_t ret = write(r->evfd, &one, sizeof(one));
+        (void)ret;
+    }
+}
+
+/* * Waits until `need` bytes are free past head. With `timeout` it gives up (-1)
+ * after RING_FULL_TIMEOUT_MS, otherwise it waits for as long as it takes.
+ */
+static int wait_space(SpscRing *r, uint32_t head, size_t need, int timeout) {
+    int waited_us = 0;
+    while (RING_SIZE - (head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE)) < need) {
+        // Full: make sure the consumer is awake, then back off
+        notify(r);
+        if (timeout && waited_us >= RING_FULL_TIMEOUT_MS * 1000) return -1;
+        struct timespec ts = { 0, RING_FULL_WAIT_US * 1000L };
+        nanosleep(&ts, NULL);
+        waited_us += RING_FULL_WAIT_US;
+    }
+    return 0;
+}
+
+/* * A frame is written whole or not at all: the consumer could not resync after
+ * a truncated one. The timeout only applies before the first byte; a frame that
+ * fits the ring is published in one go, a larger one streams through in chunks.
+ */
+int ring_write(SpscRing *r, const struct iovec *iov, int cnt) {
+    uint32_t head = r->head;   // Only this side writes head
+    size_t total = 0;
+    for (int k = 0; k < cnt; k++) total += iov[k].iov_len;
+    int chunked = total > RING_SIZE;
+
+    if (wait_space(r, head, chunked ? RING_SIZE : total, 1) < 0) {
+        logMessage(LOG_PATH, "[RING] Consumer stalled, dropping a %zu-byte frame", total);
+        return -1;
+    }
+
+    for (int k = 0; k < cnt; k++) {
+        const uint8_t *src = iov[k].iov_base;
+        size_t left = iov[k].iov_len;
+
+        while (left > 0) {
+            uint32_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+            size_t space = RING_SIZE - (head - tail);
+            if (space == 0) {
+                wait_space(r, head, 1, 0);   // Only when chunked: part of the frame is out already
+                continue;
+            }
+            size_t n = left < space ? left : space;
+            size_t off = head & (RING_SIZE - 1);
+            size_t first = n < RING_SIZE - off ? n : RING_SIZE - off;
+            memcpy(r->data + off, src, first);
+            memcpy(r->data, src + first, n - first);
+
+            head += (uint32_t)n;
+            src += n;
+            left -= n;
+            if (chunked) __atomic_store_n(&r->head, head, __ATOMIC_RELEASE);
+        }
+    }
+    __atomic_store_n(&r->head, head, __ATOMIC_RELEASE);
+    notify(r);
+    return 0;
+}
+
+ssize_t ring_read(SpscRing *r, void *buf, size_t max) {
+    // Consume a pending wakeup first, so a signal for bytes arriving from now on
+    // is kept. A consumer that never parks never touches the eventfd.
+    if (r->armed) {
+        uint64_t cnt;
+        ssize_t ret = read(r->evfd, &cnt, sizeof(cnt));
+        (void)ret;
+        r->armed = 0;
+    }
+
+    uint32_t tail = r->tail;   // Only this side writes tail
+    uint32_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    size_t n = head - tail;
+    if (n == 0) {
+        errno = EAGAIN;
+        return -1;
+    }
+    if (n > max) n = max;
+    size_t off = tail & (RING_SIZE - 1);
+    size_t first = n < RING_SIZE - off ? n : RING_SIZE - off;
+    memcpy(buf, r->data + off, first);
+    memcpy((uint8_t *)buf + first, r->data, n - first);
+    __atomic_store_n(&r->tail, tail + (uint32_t)n, __ATOMIC_RELEASE);
+    return (ssize_t)n;
+}
+
+void ring_park(SpscRing *r) {
+    r->armed = 1;
+    __atomic_store_n(&r->parked, 1, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);   // parked store before the head load
+    if (__atomic_load_n(&r->head, __ATOMIC_ACQUIRE) != r->tail &&
+        __atomic_exchange_n(&r->parked, 0, __ATOMIC_SEQ_CST)) {
+        uint64_t one = 1;
+        ssize_t ret = write(r->evfd, &one, sizeof(one));
+        (void)ret;
+    }
+}
+
+void ring_close_unused(const int evfds[RING_LINKS], int keep_a, int keep_b) {
+    for (int i = 0; i < RING_LINKS; i++) {
+        if (i != keep_a && i != keep_b) close(evfds[i]);
+    }
+}
@@ -0,0 +1,73 @@
+// ipc_ring.h
+#ifndef IPC_RING_H
+#define IPC_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#define RING_SHM_PREFIX "/arp_ring_"
+#define RING_NAME_LEN 64
+#define RING_SIZE (1u << 18)          // Bytes per direction (power of two)
+#define RING_FULL_WAIT_US 50          // Producer back-off while the ring is full
+#define RING_FULL_TIMEOUT_MS 2000     // Gives up on a consumer that stopped reading
+
+/* Framed links that can run on a ring instead of a pipe (one ring per direction) */
+enum {
+    RING_BB_DRONE, RING_DRONE_BB,
+    RING_BB_OBST,  RING_OBST_BB,
+    RING_BB_TARG,  RING_TARG_BB,
+    RING_LINKS
+};
+
+/* * Single-producer/single-consumer byte ring living in shared memory.
+ * head/tail are free-running counters (index = counter & (RING_SIZE-1)), each
+ * written by one side only, on separate cache lines. The consumer raises
+ * `parked` before it sleeps in select() on the ring's eventfd; the producer
+ * only writes the eventfd when it finds the flag set, so a consumer that keeps
+ * polling (the drone) costs no syscall at all.
+ */
+typedef struct {
+    _Alignas(64) uint32_t head;       // Producer position
+    _Alignas(64) uint32_t tail;       // Consumer position
+    _Alignas(64) uint32_t parked;     // Consumer waits for a wakeup
+    int evfd;                         // Same descriptor number in every process (inherited)
+    uint32_t armed;                   // Consumer-private: parked since its last eventfd read
+    _Alignas(64) uint8_t data[RING_SIZE];
+} SpscRing;
+
+typedef struct {
+    SpscRing rings[RING_LINKS];
+} RingShm;
+
+/* * Creates and maps the ring object and one eventfd per link (main, before fork).
+ * evfds[] receives the descriptors that replace the pipe ends on the command line.
+ * Returns 0 on success, -1 if the object or an eventfd could not be created.
+ */
+int ring_shm_create(const char *name, int evfds[RING_LINKS]);
+
+/* * Child side: maps the object and binds each descriptor of fds[] (as received
+ * on the command line) to its ring, so frame_send()/frame_fill() use the ring.
+ * Returns 0 on success.
+ */
+int ring_attach(const char *name, const int *fds, int n);
+
+// Ring bound to fd by ring_attach(), NULL for a plain pipe
+SpscRing* ring_lookup(int fd);
+
+// Copies one frame (the gathered pieces) into the ring, waiting for space; -1 if it was dropped whole
+int ring_write(SpscRing *r, const struct iovec *iov, int cnt);
+
+// Up to `max` bytes. Returns the count, or -1 with errno EAGAIN when empty
+ssize_t ring_read(SpscRing *r, void *buf, size_t max);
+
+/* * Call before select() on the ring's descriptor: marks the consumer parked and
+ * makes the eventfd readable right away if bytes are already waiting.
+ */
+void ring_park(SpscRing *r);
+
+// Closes every eventfd of evfds[] except keep_a and keep_b (child branches of main)
+void ring_close_unused(const int evfds[RING_LINKS], int keep_a, int keep_b);
+
+#endif
@@ -9,6 +9,7 @@
 #include <string.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
@@ -16,6 +17,34 @@
 #include "log.h"
 #include "app_common.h"
 #include "process_pid.h"
+#include "params.h"
+#include "drone_shm.h"
+#include "ipc_ring.h"
+
+/* Shared-memory rings (IPC_SHM_RINGS): one eventfd per framed link */
+static int ring_fd[RING_LINKS];
+static int use_rings = 0;
+
+/* Descriptor handed to a child for a framed link: the ring's eventfd, or the pipe end */
+static int link_fd(int link, int pipe_end) {
+    return use_rings ? ring_fd[link] : pipe_end;
+}
+
+/* HEADLESS 1 in params.txt: no konsole windows (CI, servers, soak tests) */
+static int headless = 0;
+
+/* Runs argv (NULL-terminated) in its own konsole window, or directly when headless */
+static void exec_in_terminal(char *argv[]) {
+    if (headless) {
+        execv(argv[0], argv);
+        return;
+    }
+    char *term_argv[24] = { "konsole", "-e" };
+    int n = 2;
+    for (int i = 0; argv[i] && n < 23; i++) term_argv[n++] = argv[i];
+    term_argv[n] = NULL;
+    execvp("konsole", term_argv);
+}
 
 /* --------------------------------------------------------------------------------------
  * SECTION 1: LOG DIRECTORY CREATION
@@ -74,10 +103,37 @@ int main(void) {
     logMessage(LOG_PATH, "[MAIN] Starting in MODE: %d", mode);
     if(mode == MODE_NETWORKED) logMessage(LOG_PATH_SC, "[MAIN] Network role: %d", role);
 
+    headless = param_int("HEADLESS", 0);
+    if (headless) logMessage(LOG_PATH, "[MAIN] Headless run: no konsole, blackboard without a terminal");
+
     char arg_mode[4], arg_role[4];
     snprintf(arg_mode, sizeof(arg_mode), "%d", mode);
     snprintf(arg_role, sizeof(arg_role), "%d", role);
 
+    /* --- SHARED DRONE STATE (DRONE_STATE_SHM in params.txt) --- */
+    // Drone and Blackboard get the object name as an extra argument;
+    // without it they fall back to position/force messages on the pipe.
+    char shm_name[DRONE_SHM_NAME_LEN];
+    snprintf(shm_name, sizeof(shm_name), "%s%d", DRONE_SHM_PREFIX, getpid());
+    const char *arg_shm = NULL;
+    if (param_int("DRONE_STATE_SHM", 1) && drone_shm_create(shm_name) == 0) {
+        arg_shm = shm_name;
+        logMessage(LOG_PATH, "[MAIN] Drone state shared memory: %s", shm_name);
+    }
+
+    /* --- SHARED-MEMORY RINGS (IPC_SHM_RINGS in params.txt) --- */
+    // Blackboard <-> drone/obstacle/target frames go through SPSC rings; the
+    // eventfds take the place of the pipe ends and the object name is one more
+    // argument. The pipes below are still created: they are the fallback.
+    char ring_name[RING_NAME_LEN];
+    snprintf(ring_name, sizeof(ring_name), "%s%d", RING_SHM_PREFIX, getpid());
+    const char *arg_ring = NULL;
+    if (param_int("IPC_SHM_RINGS", 0) && ring_shm_create(ring_name, ring_fd) == 0) {
+        use_rings = 1;
+        arg_ring = ring_name;
+        logMessage(LOG_PATH, "[MAIN] Shared-memory rings: %s", ring_name);
+    }
+
     /* --- PIPE CREATION --- */
     int pipe_input_bb[2], pipe_bb_drone[2], pipe_drone_bb[2];
     int pipe_bb_obst[2], pipe_obst_bb[2];
@@ -113,9 +169,11 @@ int main(void) {
         close(pipe_bb_wd[0]); close(pipe_bb_wd[1]);
         close(pipe_bb_network[0]); close(pipe_bb_network[1]);
         close(pipe_network_bb[0]); close(pipe_network_bb[1]);
+        if (use_rings) ring_close_unused(ring_fd, -1, -1);
 
         char fd_out[16]; snprintf(fd_out, sizeof(fd_out), "%d", pipe_input_bb[1]);
-        execlp("konsole", "konsole", "-e", "./exec/input", fd_out, arg_mode, NULL);
+        char *input_argv[] = { "./exec/input", fd_out, arg_mode, NULL };
+        exec_in_terminal(input_argv);
         perror("exec input");
         exit(1);
     }
@@ -128,7 +186,7 @@ int main(void) {
         close(pipe_bb_drone[0]); close(pipe_drone_bb[1]);
         close(pipe_bb_obst[0]); close(pipe_obst_bb[1]);
         close(pipe_bb_target[0]); close(pipe_target_bb[1]);
-        close(pipe_bb_wd[0]); close(pipe_bb_wd[1]);
+        close(pipe_bb_wd[0]);
         close(pipe_bb_network[0]); close(pipe_network_bb[1]);
 
         char fd_in_input[16], fd_in_drone[16], fd_out_drone[16];
@@ -137,12 +195,12 @@ int main(void) {
         char fd_out_wd[16], fd_out_network[16], fd_in_network[16], arg_port[16];
 
         snprintf(fd_in_input,   sizeof(fd_in_input),   "%d", pipe_input_bb[0]);
-        snprintf(fd_in_drone,   sizeof(fd_in_drone),   "%d", pipe_drone_bb[0]);
-        snprintf(fd_out_drone,  sizeof(fd_out_drone),  "%d", pipe_bb_drone[1]);
-        snprintf(fd_out_obst,   sizeof(fd_out_obst),   "%d", pipe_bb_obst[1]);
-        snprintf(fd_in_obst,    sizeof(fd_in_obst),    "%d", pipe_obst_bb[0]);
-        snprintf(fd_out_target, sizeof(fd_out_target), "%d", pipe_bb_target[1]);
-        snprintf(fd_in_target,  sizeof(fd_in_target),  "%d", pipe_target_bb[0]);
+        snprintf(fd_in_drone,   sizeof(fd_in_drone),   "%d", link_fd(RING_DRONE_BB, pipe_drone_bb[0]));
+        snprintf(fd_out_drone,  sizeof(fd_out_drone),  "%d", link_fd(RING_BB_DRONE, pipe_bb_drone[1]));
+        snprintf(fd_out_obst,   sizeof(fd_out_obst),   "%d", link_fd(RING_BB_OBST, pipe_bb_obst[1]));
+        snprintf(fd_in_obst,    sizeof(fd_in_obst),    "%d", link_fd(RING_OBST_BB, pipe_obst_bb[0]));
+        snprintf(fd_out_target, sizeof(fd_out_target), "%d", link_fd(RING_BB_TARG, pipe_bb_target[1]));
+        snprintf(fd_in_target,  sizeof(fd_in_target),  "%d", link_fd(RING_TARG_BB, pipe_target_bb[0]));
         snprintf(fd_out_wd,     sizeof(fd_out_wd),     "%d", pipe_bb_wd[1]);
         snprintf(arg_port,      sizeof(arg_port),      "%d", port_number);
         snprintf(fd_out_network,sizeof(fd_out_network),"%d", pipe_bb_network[1]);
@@ -150,7 +208,7 @@ int main(void) {
 
         if (strlen(server_address) == 0) strcpy(server_address, "0.0.0.0");
 
-        execlp("konsole", "konsole", "-e",
+        char *bb_argv[] = {
             "./exec/blackboard",
             fd_in_input, fd_in_drone,
             fd_out_drone, fd_out_obst,
@@ -158,7 +216,8 @@ int main(void) {
             fd_in_target, fd_out_wd,
             arg_mode, server_address,
             fd_out_network, fd_in_network,
-            arg_role, NULL);
+            arg_role, (char *)(arg_shm ? arg_shm : "-"), (char *)arg_ring, NULL };
+        exec_in_terminal(bb_argv);
 
         perror("exec blackboard");
         exit(1);
@@ -177,12 +236,14 @@ int main(void) {
         close(pipe_bb_wd[0]); close(pipe_bb_wd[1]);
         close(pipe_bb_network[0]); close(pipe_bb_network[1]);
         close(pipe_network_bb[0]); close(pipe_network_bb[1]);
+        if (use_rings) ring_close_unused(ring_fd, RING_BB_DRONE, RING_DRONE_BB);
 
         char fd_in[16], fd_out[16];
-        snprintf(fd_in,  sizeof(fd_in),  "%d", pipe_bb_drone[0]);
-        snprintf(fd_out, sizeof(fd_out), "%d", pipe_drone_bb[1]);
+        snprintf(fd_in,  sizeof(fd_in),  "%d", link_fd(RING_BB_DRONE, pipe_bb_drone[0]));
+        snprintf(fd_out, sizeof(fd_out), "%d", link_fd(RING_DRONE_BB, pipe_drone_bb[1]));
 
-        execlp("./exec/drone", "./exec/drone", fd_in, fd_out, arg_mode, arg_role, NULL);
+        execlp("./exec/drone", "./exec/drone", fd_in, fd_out, arg_mode, arg_role,
+               arg_shm ? arg_shm : "-", arg_ring, NULL);
         perror("exec drone");
         exit(1);
     }
@@ -208,12 +269,13 @@ int main(void) {
             close(pipe_bb_wd[0]); close(pipe_bb_wd[1]);
             close(pipe_bb_network[0]); close(pipe_bb_network[1]);
             close(pipe_network_bb[0]); close(pipe_network_bb[1]);
+            if (use_rings) ring_close_unused(ring_fd, RING_BB_OBST, RING_OBST_BB);
 
             char fd_in[16], fd_out[16];
-            snprintf(fd_in,  sizeof(fd_in),  "%d", pipe_bb_obst[0]);
-            snprintf(fd_out, sizeof(fd_out), "%d", pipe_obst_bb[1]);
+            snprintf(fd_in,  sizeof(fd_in),  "%d", link_fd(RING_BB_OBST, pipe_bb_obst[0]));
+            snprintf(fd_out, sizeof(fd_out), "%d", link_fd(RING_OBST_BB, pipe_obst_bb[1]));
 
-            execlp("./exec/obstacle", "./exec/obstacle", fd_in, fd_out, NULL);
+            execlp("./exec/obstacle", "./exec/obstacle", fd_in, fd_out, arg_ring, NULL);
             perror("exec obstacle");
             exit(1);
         }
@@ -235,12 +297,13 @@ int main(void) {
             close(pipe_bb_wd[0]); close(pipe_bb_wd[1]);
             close(pipe_bb_network[0]); close(pipe_bb_network[1]);
             close(pipe_network_bb[0]); close(pipe_network_bb[1]);
+            if (use_rings) ring_close_unused(ring_fd, RING_BB_TARG, RING_TARG_BB);
 
             char fd_in[16], fd_out[16];
-            snprintf(fd_in,  sizeof(fd_in),  "%d", pipe_bb_target[0]);
-            snprintf(fd_out, sizeof(fd_out), "%d", pipe_target_bb[1]);
+            snprintf(fd_in,  sizeof(fd_in),  "%d", link_fd(RING_BB_TARG, pipe_bb_target[0]));
+            snprintf(fd_out, sizeof(fd_out), "%d", link_fd(RING_TARG_BB, pipe_target_bb[1]));
 
-            execlp("./exec/target", "./exec/target", fd_in, fd_out, NULL);
+            execlp("./exec/target", "./exec/target", fd_in, fd_out, arg_ring, NULL);
             perror("exec target");
             exit(1);
         }
@@ -263,9 +326,11 @@ int main(void) {
             close(pipe_target_bb[0]); close(pipe_target_bb[1]);
             close(pipe_bb_network[0]); close(pipe_bb_network[1]);
             close(pipe_network_bb[0]); close(pipe_network_bb[1]);
+            if (use_rings) ring_close_unused(ring_fd, -1, -1);
 
             char fd_in_bb[16]; snprintf(fd_in_bb, sizeof(fd_in_bb), "%d", pipe_bb_wd[0]);
-            execlp("konsole", "konsole", "-e", "./exec/watchdog", fd_in_bb, NULL);
+            char *wd_argv[] = { "./exec/watchdog", fd_in_bb, NULL };
+            exec_in_terminal(wd_argv);
             perror("exec watchdog");
             exit(1);
         }
@@ -283,6 +348,7 @@ int main(void) {
             close(pipe_bb_target[0]); close(pipe_bb_target[1]);
             close(pipe_target_bb[0]); close(pipe_target_bb[1]);
             close(pipe_bb_wd[0]); close(pipe_bb_wd[1]);
+            if (use_rings) ring_close_unused(ring_fd, -1, -1);
 
             char fd_out_bb[16], fd_in_bb[16], arg_port[16];
             snprintf(fd_out_bb, sizeof(fd_out_bb), "%d", pipe_network_bb[1]);
@@ -311,12 +377,15 @@ int main(void) {
     close(pipe_bb_wd[0]); close(pipe_bb_wd[1]);
     close(pipe_bb_network[0]); close(pipe_bb_network[1]);
     close(pipe_network_bb[0]); close(pipe_network_bb[1]);
+    if (use_rings) ring_close_unused(ring_fd, -1, -1);
 
     logMessage(LOG_PATH, "[MAIN] All processes started (input=%d drone=%d bb=%d obst=%d targ=%d watchdog=%d network=%d)",
         pid_input, pid_drone, pid_bb, pid_obst, pid_target, pid_watchdog, pid_network);
 
     /* --- WAIT FOR CHILDREN --- */
     while (wait(NULL) > 0);
+    if (arg_shm) shm_unlink(arg_shm);
+    if (arg_ring) shm_unlink(arg_ring);
     logMessage(LOG_PATH, "[MAIN] PROGRAM EXIT");
 
     return 0;
@@ -15,17 +15,37 @@
 #include <math.h>
 #include <signal.h>
 #include <sys/socket.h>
-#include <sys/select.h> 
+#include <sys/select.h>
+#include <sys/epoll.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <stdarg.h>
+#include <assert.h>
 
 #include "app_common.h"
 #include "log.h"
+#include "params.h"
 
-#define BUFSZ 1024 
+#define BUFSZ 1024
+#define NET_PROTOCOL_DEFAULT "stream"   // NET_PROTOCOL in params.txt (lockstep, stream)
+#define NET_STREAM_HZ_DEFAULT 100       // NET_STREAM_HZ: updates per second pushed in stream mode
+#define NET_TRANSPORT_DEFAULT "tcp"     // NET_TRANSPORT: tcp, or udp for the stream updates
+#define NET_WIRE_DEFAULT "bin"          // NET_WIRE: text "st" lines, or bin frames for the stream
+#define NET_MAX_CLIENTS_DEFAULT 512     // NET_MAX_CLIENTS: sessions the server accepts at once
+#define NET_STREAM_WINDOW 32            // Updates in flight (sent, not yet acknowledged)
+#define NET_STREAM_PROBE_MS 100         // Window full: one update anyway after this long (lost acks)
+#define NET_NEGOTIATE_MS 2000           // Wait for "mok" before assuming a lock-step-only peer
+#define NET_HANDSHAKE_MS 10000          // Server: a client still not past "ook"/"sok" is dropped
+#define NET_OUTBUF 65536                // Bytes queued per peer while its socket is full
+#define NET_STALL_MS 5000               // Server: a client whose socket stays full this long is dropped
+#define NET_PEER_RECORD_MAX 64          // Longest "pe" line / BIN_PEER frame
+#define NET_MAX_CLIENTS_LIMIT (NET_OUTBUF / NET_PEER_RECORD_MAX)   // A full fan-out batch fits one buffer
+#define NET_ID_MAX 0xffff               // Client ids travel as u16 (0 is the server's drone)
+#define NET_EPOLL_EVENTS 64
+#define NET_STATS_PERIOD_MS 10000
 
-/* * Rotation angle for coordinate transformation. 
+/* * Rotation angle for coordinate transformation.
  * If non-zero, the view is rotated between Local and Virtual space.
  */
 static float alpha = 0.0f;
@@ -34,13 +54,17 @@ static float alpha = 0.0f;
  * The protocol follows a strict sequence: Command -> Data -> Acknowledgment.
  */
 typedef enum {
-    // SERVER STATES
+    // SERVER STATES (the three handshake states first, see in_handshake())
+    SV_WAIT_OOK,         // Handshake: sent "ok", waiting for "ook"
+    SV_WAIT_SOK,         // Handshake: sent "size W H", waiting for "sok W H"
+    SV_WAIT_MOK,         // Handshake: offered "mode ...", waiting for "mok ..."
+    SV_STREAM,           // Negotiated stream session (MACRO-SECTION 6)
     SV_SEND_CMD_DRONE,   // Tell client: "I am sending drone data"
     SV_SEND_DATA_DRONE,  // Send actual coordinates
     SV_WAIT_DOK,         // Wait for Client to acknowledge drone data
     SV_SEND_CMD_OBST,    // Tell client: "Send me your obstacle data"
     SV_WAIT_DATA_OBST,   // Wait for Client to reply with data
-    
+
     // CLIENT STATES
     CL_WAIT_COMMAND,     // Idle, waiting for Server instruction
     CL_WAIT_DRONE_DATA,  // Server said "drone", waiting for coords
@@ -48,8 +72,16 @@ typedef enum {
     CL_WAIT_POK          // Wait for Server to acknowledge my data
 } NetState;
 
-static NetState net_state;
-static int net_fd = -1;
+/* * Session options agreed in the handshake ("mode ..." / "mok ...").
+ * A peer that does not know the negotiation keeps the lock-step exchange.
+ */
+typedef struct {
+    int stream;          // Pipelined state updates instead of drone/dok/obst/pok
+    int udp;             // Stream updates in UDP datagrams (TCP keeps handshake and quit)
+    int udp_port;        // Peer's UDP port
+    int bin;             // Stream in binary frames with quantized coordinates
+    int multi;           // Client also receives the other clients' drones ("pe" / "pg")
+} NetOptions;
 
 /* * Buffer structure for Non-Blocking I/O.
  * Accumulates partial reads until a full newline-terminated message is found.
@@ -59,7 +91,62 @@ typedef struct {
     int len;
 } SocketBuffer;
 
-static SocketBuffer sock_buf = { .len = 0 };
+/* * Bytes written while the socket was full, sent as soon as it is writable again.
+ */
+typedef struct {
+    char data[NET_OUTBUF];
+    int len;
+} OutBuffer;
+
+/* * Per-session state of the streaming protocol (MACRO-SECTION 6).
+ */
+typedef struct {
+    uint32_t seq;            // Last update sent
+    uint32_t peer_acked;     // Newest of our updates acknowledged by the peer
+    uint32_t peer_seq;       // Newest peer update received
+    uint32_t acked_peer;     // Newest peer update we acknowledged
+    long sent_ms[NET_STREAM_WINDOW];   // Send time of our updates, by seq % window
+    float sent_x, sent_y;    // Position carried by the last update
+    long t0;                 // Session start (t_ms origin)
+    long last_tx_ms;
+    int loss_pct;            // NET_UDP_LOSS: outgoing datagrams dropped on purpose
+    unsigned long tx, rx, stale, missed, window_full, dropped;
+    unsigned long bytes_tx;
+    unsigned long rejected;  // Server: "pe"/"pg" records from a client (only the server sends them)
+    double rtt_sum;
+    unsigned long rtt_count;
+} StreamState;
+
+/* * One connection to a peer and everything kept per connection. A client has a
+ * single peer (the server); the server has one per connected client (MACRO-SECTION 7).
+ * `id` is the remote drone id of this peer on the Blackboard: 0 for the server's
+ * drone, the session number for a client's.
+ */
+typedef struct {
+    int fd;
+    int id;
+    SocketBuffer in;
+    OutBuffer out;
+    NetOptions opts;
+    int udp_fd;              // Stream datagrams (-1 = none)
+    NetState state;
+    StreamState st;
+
+    // Server side only
+    long deadline_ms;        // The current handshake step must be done by then
+    float vx, vy;            // Newest position of the peer's drone (virtual)
+    long rx_ms;              // When it arrived (now_ms)
+    unsigned long moved;     // Fan-out epoch of its last move (0 = no position yet)
+    unsigned long synced;    // Fan-out epoch up to which the other drones were sent to it
+    long stalled_ms;         // When `out` last became non-empty (the socket was full)
+    int watch_out;           // EPOLLOUT registered (output pending)
+    int dead;                // Closed at the end of the current event batch
+} Peer;
+
+static Peer net_peer = { .fd = -1, .udp_fd = -1 };   // Client: the server
+static int wire_w = 100, wire_h = 100;   // Handshake "size W H": range of the quantized coordinates
+static int log_traffic = 1;   // Every line sent/parsed is logged (off in stream mode: stats instead)
+static unsigned long hub_epoch = 1;      // Server: fan-out rounds (one per stream tick)
 
 /* Cached local positions to be sent over the network */
 static float my_last_x = 0.0f;
@@ -75,6 +162,10 @@ static float my_last_y = 0.0f;
 /* Debug helper: Converts State Enum to String */
 const char* state_to_str(NetState s) {
     switch(s) {
+        case SV_WAIT_OOK: return "SV_WAIT_OOK";
+        case SV_WAIT_SOK: return "SV_WAIT_SOK";
+        case SV_WAIT_MOK: return "SV_WAIT_MOK";
+        case SV_STREAM: return "SV_STREAM";
         case SV_SEND_CMD_DRONE: return "SV_SEND_CMD_DRONE";
         case SV_SEND_DATA_DRONE: return "SV_SEND_DATA_DRONE";
         case SV_WAIT_DOK: return "SV_WAIT_DOK";
@@ -88,12 +179,17 @@ const char* state_to_str(NetState s) {
     }
 }
 
+/* 1 while the server side of the handshake is still running */
+static int in_handshake(const Peer *p) {
+    return p->state <= SV_WAIT_MOK;
+}
+
 /* * Converts Local Coordinates (Screen pixels) to Virtual Coordinates (Shared World).
  * Applies rotation if alpha != 0.
  */
-void local_to_virt(float lx, float ly, float *vx, float *vy) { 
+void local_to_virt(float lx, float ly, float *vx, float *vy) {
     float x = lx;
-    float y = ly; 
+    float y = ly;
 
     if(alpha != 0.0f) {
         float cos_a = cosf(alpha);
@@ -109,7 +205,7 @@ void local_to_virt(float lx, float ly, float *vx, float *vy) {
 
 /* * Converts Virtual Coordinates (Shared World) back to Local Coordinates (Screen pixels).
  */
-void virt_to_local(float vx, float vy, float *lx, float *ly) { 
+void virt_to_local(float vx, float vy, float *lx, float *ly) {
     float x = vx;
     float y = vy;
 
@@ -129,7 +225,14 @@ void virt_to_local(float vx, float vy, float *lx, float *ly) {
 void set_nonblocking(int fd) {
     int flags = fcntl(fd, F_GETFL, 0);
     if (flags != -1) fcntl(fd, F_SETFL, flags | O_NONBLOCK);
-    logMessage(LOG_PATH_SC, "[NET] FD %d set to non-blocking", fd);
+    if (log_traffic) logMessage(LOG_PATH_SC, "[NET] FD %d set to non-blocking", fd);
+}
+
+/* Monotonic milliseconds (stream timestamps, tick scheduling) */
+long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
 }
 
 
@@ -139,81 +242,125 @@ void set_nonblocking(int fd) {
  * Functions handling raw socket reads/writes, ensuring strict newline delimitation.
  */
 
+/* * Writes to the peer's socket; whatever the socket does not take now is kept in
+ * `out` and sent by peer_flush() once it is writable. Nothing is ever dropped
+ * half-way, so a slow peer cannot receive a truncated line or frame.
+ * Returns -1 if the connection failed or `out` is full (the peer stopped reading).
+ */
+int peer_write(Peer *p, const void *buf, int len) {
+    const char *data = buf;
+    if (p->out.len == 0) {
+        ssize_t n = write(p->fd, data, len);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                if (errno != EPIPE) logMessage(LOG_PATH_SC, "[NET] ERROR sending: %s", strerror(errno));
+                return -1;
+            }
+            n = 0;
+        }
+        data += n;
+        len -= n;
+    }
+    if (len == 0) return 0;
+    if (p->out.len + len > NET_OUTBUF) {
+        logMessage(LOG_PATH_SC, "[NET] Peer %d not reading: output buffer full", p->id);
+        return -1;
+    }
+    if (p->out.len == 0) p->stalled_ms = now_ms();
+    memcpy(p->out.data + p->out.len, data, len);
+    p->out.len += len;
+    return 0;
+}
+
+/* Sends what is pending in `out`. Returns -1 if the connection failed. */
+int peer_flush(Peer *p) {
+    if (p->out.len == 0) return 0;
+    ssize_t n = write(p->fd, p->out.data, p->out.len);
+    if (n < 0) return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    p->out.len -= n;
+    memmove(p->out.data, p->out.data + n, p->out.len);
+    return 0;
+}
+
 /* * Formats and sends a message ensuring strict Protocol adherence.
  * The protocol requires every message to end with '\n'.
  */
-void send_msg(int fd, const char *fmt, ...) {
+int send_msg(Peer *p, const char *fmt, ...) {
     char buf[BUFSZ];
     va_list args;
-    
+
     // 1. Format string into buffer
     va_start(args, fmt);
     vsnprintf(buf, sizeof(buf) - 2, fmt, args); // Reserve space for \n and \0
     va_end(args);
 
     int len = strlen(buf);
-    
+
     // 2. Log raw data before modification
-    logMessage(LOG_PATH_SC, "[NET-OUT] Sending raw data: '%s'", buf);
+    if (log_traffic) logMessage(LOG_PATH_SC, "[NET-OUT] Sending raw data: '%s'", buf);
 
     // 3. FORCE NEWLINE: The protocol relies on \n to detect end of message
     if (len == 0 || buf[len-1] != '\n') {
         buf[len] = '\n';
-        buf[len+1] = '\0'; 
+        buf[len+1] = '\0';
         len++;
     }
 
-    // 4. Write to socket
-    ssize_t sent = write(fd, buf, len);
-    
-    if (sent < 0) {
-        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EPIPE)
-            logMessage(LOG_PATH_SC, "[NET] ERROR sending: %s", strerror(errno));
-    }
+    // 4. Write to socket (queued if it is full)
+    return peer_write(p, buf, len);
 }
 
-/* * Reads raw bytes from the socket into the persistent buffer `sock_buf`.
- * Returns 1 if data read, 0 if buffer full, -1 if connection closed.
+/* * Reads raw bytes from the socket into the peer's persistent buffer `in`.
+ * Returns 1 if data read, 0 if nothing to read or buffer full, -1 if connection closed.
  */
-int read_socket_chunk(int fd) {
-    if (sock_buf.len >= BUFSZ - 1) {
+int read_socket_chunk(Peer *p) {
+    SocketBuffer *sb = &p->in;
+    if (sb->len >= BUFSZ - 1) {
         logMessage(LOG_PATH_SC, "[NET-ERR] Buffer full! Cannot read more.");
-        return 0; 
+        return 0;
     }
-    
-    ssize_t n = read(fd, sock_buf.data + sock_buf.len, BUFSZ - 1 - sock_buf.len);
+
+    ssize_t n = read(p->fd, sb->data + sb->len, BUFSZ - 1 - sb->len);
     if (n > 0) {
-        sock_buf.len += n;
-        sock_buf.data[sock_buf.len] = '\0';
-        return 1; 
+        sb->len += n;
+        sb->data[sb->len] = '\0';
+        return 1;
     }
     if (n == 0) logMessage(LOG_PATH_SC, "[NET-IN] Connection closed by peer (read 0).");
-    return (n == 0) ? -1 : 0;
+    else if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return 0;
+    else logMessage(LOG_PATH_SC, "[NET-IN] Connection lost: %s", strerror(errno));
+    return -1;
 }
 
-/* * Extracts a single line from `sock_buf` based on the newline delimiter.
+/* 1 if a complete line is waiting in the peer's buffer */
+int has_line(const Peer *p) {
+    return memchr(p->in.data, '\n', p->in.len) != NULL;
+}
+
+/* * Extracts a single line from the peer's buffer based on the newline delimiter.
  * Returns 1 if a line was found and extracted, 0 otherwise.
  */
-int get_line_from_buffer(char *out_line, int max_len) {
-    char *newline_ptr = strchr(sock_buf.data, '\n');
-    
+int get_line_from_buffer(Peer *p, char *out_line, int max_len) {
+    SocketBuffer *sb = &p->in;
+    char *newline_ptr = memchr(sb->data, '\n', sb->len);
+
     if (newline_ptr) {
         // Calculate line length excluding the newline
-        int line_len = newline_ptr - sock_buf.data;
-        
+        int line_len = newline_ptr - sb->data;
+
         if (line_len >= max_len) line_len = max_len - 1;
-        
+
         // Copy the line
-        memcpy(out_line, sock_buf.data, line_len);
+        memcpy(out_line, sb->data, line_len);
         out_line[line_len] = '\0'; // Null-terminate for C string safety
-        
-        logMessage(LOG_PATH_SC, "[NET-PARSE] Extracted line (via \\n): '%s'", out_line);
+
+        if (log_traffic) logMessage(LOG_PATH_SC, "[NET-PARSE] Extracted line (via \\n): '%s'", out_line);
 
         // Shift remaining data in buffer to the front
-        int remaining = sock_buf.len - (newline_ptr - sock_buf.data) - 1;
-        memmove(sock_buf.data, newline_ptr + 1, remaining);
-        sock_buf.len = remaining;
-        sock_buf.data[sock_buf.len] = '\0';
+        int remaining = sb->len - (newline_ptr - sb->data) - 1;
+        memmove(sb->data, newline_ptr + 1, remaining);
+        sb->len = remaining;
+        sb->data[sb->len] = '\0';
         return 1;
     }
     return 0;
@@ -226,10 +373,10 @@ int read_line_blocking(int fd, char *out, int out_sz) {
     int pos = 0; char c;
     while (pos < out_sz - 1) {
         if (read(fd, &c, 1) <= 0) return -1;
-        if (c == '\n') break; 
+        if (c == '\n') break;
         out[pos++] = c;
     }
-    out[pos] = '\0'; 
+    out[pos] = '\0';
     logMessage(LOG_PATH_SC, "[HANDSHAKE] Blocking read: '%s'", out);
     return pos;
 }
@@ -239,29 +386,26 @@ int read_line_blocking(int fd, char *out, int out_sz) {
  * MACRO-SECTION 4: CONNECTION AND HANDSHAKE
  * ======================================================================================
  * Functions to initialize sockets (Bind/Listen or Connect) and perform the
- * initial strict protocol handshake to sync Client/Server.
+ * initial strict protocol handshake to sync Client/Server. The server side of the
+ * handshake runs per session in the multi-client server (MACRO-SECTION 7).
  */
 
+/* Non-blocking listening socket: the clients are accepted by the server loop */
 int init_server(int port) {
     int s = socket(AF_INET, SOCK_STREAM, 0);
     int opt = 1; setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
     struct sockaddr_in a = {0};
     a.sin_family = AF_INET; a.sin_addr.s_addr = INADDR_ANY; a.sin_port = htons(port);
-    
+
     if (bind(s, (struct sockaddr*)&a, sizeof(a)) < 0) {
         logMessage(LOG_PATH_SC, "[NET-ERR] Bind failed: %s", strerror(errno));
+        close(s);
         return -1;
     }
-    listen(s, 1);
-    logMessage(LOG_PATH_SC, "[NET-SRV] Waiting for connection on port %d...", port);
-    
-    struct sockaddr_in cli;
-    socklen_t len = sizeof(cli);
-    int client_fd = accept(s, (struct sockaddr*)&cli, &len);
-    if (client_fd >= 0) {
-        logMessage(LOG_PATH_SC, "[NET-SRV] Accepted connection from %s", inet_ntoa(cli.sin_addr));
-    }
-    return client_fd;
+    listen(s, SOMAXCONN);
+    set_nonblocking(s);
+    logMessage(LOG_PATH_SC, "[NET-SRV] Waiting for connections on port %d...", port);
+    return s;
 }
 
 int init_client(const char *addr, int port) {
@@ -269,7 +413,7 @@ int init_client(const char *addr, int port) {
     struct sockaddr_in a = {0};
     a.sin_family = AF_INET; a.sin_port = htons(port);
     inet_pton(AF_INET, addr, &a.sin_addr);
-    
+
     logMessage(LOG_PATH_SC, "[NET-CLI] Connecting to %s:%d ...", addr, port);
     while (connect(s, (struct sockaddr*)&a, sizeof(a)) < 0) {
         logMessage(LOG_PATH_SC, "[NET-CLI] Retry in 1s...");
@@ -281,64 +425,259 @@ int init_client(const char *addr, int port) {
 
 /* Helpers for Blackboard Communication */
 void send_window_size(int fd_out, int w, int h) {
-    Message msg; msg.type = MSG_TYPE_SIZE;
-    snprintf(msg.data, sizeof(msg.data), "%d %d", w, h);
-    write(fd_out, &msg, sizeof(msg));  
+    Message msg;
+    msg_init(&msg, MSG_TYPE_SIZE);
+    msg.data.size.width = w;
+    msg.data.size.height = h;
+    write(fd_out, &msg, sizeof(msg));
     logMessage(LOG_PATH_SC, "[BB-OUT] Sent Window Size: %d %d", w, h);
 }
 
 void receive_window_size(int fd_in, int *w, int *h){
     Message msg;
-    if (read(fd_in, &msg, sizeof(msg)) > 0) {
-        sscanf(msg.data, "%d %d", w, h);
+    if (read(fd_in, &msg, sizeof(msg)) > 0 && msg_valid(&msg) && msg.type == MSG_TYPE_SIZE) {
+        *w = msg.data.size.width;
+        *h = msg.data.size.height;
         logMessage(LOG_PATH_SC, "[BB-IN] Received Window Size: %d %d", *w, *h);
     }
 }
 
-void update_local_position(int fd_in) {
+/* * Remote drone `id` was at (vx, vy), virtual coordinates, at t_ms on the clock of
+ * whoever timestamped it (the Blackboard maps each drone's clock to its own).
+ */
+void forward_drone(int fd_out, int id, float vx, float vy, long t_ms) {
+    Message msg;
+    msg_init(&msg, MSG_TYPE_DRONE);
+    virt_to_local(vx, vy, &msg.data.drone.x, &msg.data.drone.y);
+    msg.data.drone.id = id;
+    msg.data.drone.t_ms = (uint32_t)t_ms;
+    write(fd_out, &msg, sizeof(msg));
+}
+
+/* Remote drone `id` left the session */
+void forward_drone_gone(int fd_out, int id) {
+    Message msg;
+    msg_init(&msg, MSG_TYPE_DRONE_GONE);
+    msg.data.drone.id = id;
+    write(fd_out, &msg, sizeof(msg));
+}
+
+/* * Clamps a received position to the handshake "size W H" (as the fixed-point
+ * frames do). Returns -1 for NaN or infinity, which has no sensible place.
+ */
+static int wire_position(float *x, float *y) {
+    if (!isfinite(*x) || !isfinite(*y)) return -1;
+    *x = fminf(fmaxf(*x, 0.0f), (float)wire_w);
+    *y = fminf(fmaxf(*y, 0.0f), (float)wire_h);
+    return 0;
+}
+
+/* * A new position of the peer's own drone: shown on the Blackboard, and kept for
+ * the fan-out to the other clients on the server.
+ */
+void peer_position(Peer *p, float vx, float vy, long t_ms, int fd_bb_out) {
+    if (wire_position(&vx, &vy) < 0) return;
+    forward_drone(fd_bb_out, p->id, vx, vy, t_ms);
+    p->vx = vx;
+    p->vy = vy;
+    p->rx_ms = now_ms();
+    p->moved = hub_epoch;
+}
+
+/* * Drains the Blackboard pipe, keeping only the newest local position.
+ * Returns -1 when the Blackboard quits (MSG_TYPE_EXIT or pipe closed).
+ */
+int update_local_position(int fd_in) {
     Message msg;
-    while (read(fd_in, &msg, sizeof(msg)) > 0) {
-        sscanf(msg.data, "%f %f", &my_last_x, &my_last_y);
+    ssize_t n;
+    while ((n = read(fd_in, &msg, sizeof(msg))) > 0) {
+        if (!msg_valid(&msg)) continue;
+        if (msg.type == MSG_TYPE_EXIT) return -1;
+        if (msg.type != MSG_TYPE_POSITION) continue;
+        my_last_x = msg.data.pos.x;
+        my_last_y = msg.data.pos.y;
+    }
+    return n == 0 ? -1 : 0;
+}
+
+/* * Options this side is configured to use (params.txt).
+ */
+NetOptions wanted_options(void) {
+    NetOptions o = {0};
+    char proto[32];
+    param_str("NET_PROTOCOL", NET_PROTOCOL_DEFAULT, proto, sizeof(proto));
+    o.stream = strcmp(proto, "stream") == 0;
+    param_str("NET_TRANSPORT", NET_TRANSPORT_DEFAULT, proto, sizeof(proto));
+    o.udp = o.stream && strcmp(proto, "udp") == 0;
+    param_str("NET_WIRE", NET_WIRE_DEFAULT, proto, sizeof(proto));
+    o.bin = o.stream && strcmp(proto, "bin") == 0;
+    o.multi = o.stream;
+    return o;
+}
+
+/* * UDP socket for the peer's stream updates, bound to an ephemeral port.
+ * Returns the port, or -1 (the session then streams over TCP).
+ */
+int open_udp(Peer *p) {
+    p->udp_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (p->udp_fd < 0) return -1;
+    struct sockaddr_in a = {0};
+    socklen_t len = sizeof(a);
+    a.sin_family = AF_INET; a.sin_addr.s_addr = INADDR_ANY; a.sin_port = 0;
+    if (bind(p->udp_fd, (struct sockaddr*)&a, sizeof(a)) < 0 || getsockname(p->udp_fd, (struct sockaddr*)&a, &len) < 0) {
+        logMessage(LOG_PATH_SC, "[NET-ERR] UDP socket: %s", strerror(errno));
+        close(p->udp_fd);
+        p->udp_fd = -1;
+        return -1;
+    }
+    return ntohs(a.sin_port);
+}
+
+/* * Connects the UDP socket to the peer: same address as the TCP connection, the
+ * port announced in the negotiation. Datagrams from anyone else are then dropped.
+ */
+int connect_udp(Peer *p, int port) {
+    struct sockaddr_in a;
+    socklen_t len = sizeof(a);
+    if (getpeername(p->fd, (struct sockaddr*)&a, &len) < 0) return -1;
+    a.sin_port = htons(port);
+    if (connect(p->udp_fd, (struct sockaddr*)&a, sizeof(a)) < 0) {
+        logMessage(LOG_PATH_SC, "[NET-ERR] UDP connect: %s", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+void close_udp(Peer *p) {
+    if (p->udp_fd >= 0) close(p->udp_fd);
+    p->udp_fd = -1;
+    p->opts.udp = 0;
+}
+
+/* * Server side of the option negotiation, after "sok": sends "mode <options>".
+ * Options: "stream", and with it "bin", "multi" and "udp <port>" (the sender's
+ * UDP port). A client that predates the negotiation ignores the line (any unknown
+ * command is dropped in CL_WAIT_COMMAND) and never answers: after NET_NEGOTIATE_MS
+ * the session stays lock-step.
+ * Returns 0 if nothing was offered (lock-step only configured).
+ */
+int offer_options(Peer *p) {
+    NetOptions want = wanted_options();
+    if (!want.stream) return 0;
+
+    char offer[BUFSZ] = "mode stream";
+    int port = want.udp ? open_udp(p) : -1;
+    if (want.bin) strcat(offer, " bin");
+    if (want.multi) strcat(offer, " multi");
+    if (port > 0) snprintf(offer + strlen(offer), sizeof(offer) - strlen(offer), " udp %d", port);
+    send_msg(p, "%s", offer);
+    return 1;
+}
+
+/* * The client's "mok <accepted options>", or NULL if it did not answer in time.
+ */
+void accept_options(Peer *p, char *reply) {
+    NetOptions want = wanted_options();
+    if (!reply) {
+        logMessage(LOG_PATH_SC, "[HANDSHAKE] No 'mok' from client %d: lock-step protocol", p->id);
+    } else if (strncmp(reply, "mok", 3) != 0) {
+        logMessage(LOG_PATH_SC, "[HANDSHAKE] Expected 'mok', got '%s': lock-step protocol", reply);
+    } else {
+        for (char *tok = strtok(reply + 3, " "); tok; tok = strtok(NULL, " ")) {
+            if (strcmp(tok, "stream") == 0) p->opts.stream = 1;
+            else if (strcmp(tok, "bin") == 0) p->opts.bin = want.bin;
+            else if (strcmp(tok, "multi") == 0) p->opts.multi = want.multi;
+            else if (strcmp(tok, "udp") == 0 && (tok = strtok(NULL, " "))) {
+                p->opts.udp_port = atoi(tok);
+                p->opts.udp = p->udp_fd >= 0 && p->opts.udp_port > 0;
+            }
+        }
+    }
+    if (p->opts.udp && connect_udp(p, p->opts.udp_port) < 0) p->opts.udp = 0;
+    if (!p->opts.udp) close_udp(p);
+    if (!p->opts.stream) p->opts.bin = p->opts.multi = 0;
+}
+
+/* * Client side of the option negotiation: the first line after "sok" is either
+ * the offer or already the first "drone" command of a lock-step server.
+ * Returns the lock-step state to start in, or -1 on error.
+ */
+int negotiate_client(Peer *p) {
+    char buf[BUFSZ];
+    if (read_line_blocking(p->fd, buf, sizeof(buf)) < 0) return -1;
+    if (strcmp(buf, "drone") == 0) return CL_WAIT_DRONE_DATA;
+    if (strncmp(buf, "mode", 4) != 0) return CL_WAIT_COMMAND;
+
+    NetOptions want = wanted_options();
+    char reply[BUFSZ] = "mok";
+    int server_udp = 0;
+    for (char *tok = strtok(buf + 4, " "); tok; tok = strtok(NULL, " ")) {
+        if (strcmp(tok, "stream") == 0 && want.stream) {
+            p->opts.stream = 1;
+            strcat(reply, " stream");
+        } else if (strcmp(tok, "bin") == 0 && want.bin) {
+            p->opts.bin = 1;
+        } else if (strcmp(tok, "multi") == 0 && want.multi) {
+            p->opts.multi = 1;
+        } else if (strcmp(tok, "udp") == 0 && (tok = strtok(NULL, " "))) {
+            server_udp = atoi(tok);
+        }
     }
+
+    // bin, multi and UDP only with stream, and UDP only if our own socket is up and connected
+    if (!p->opts.stream) p->opts.bin = p->opts.multi = 0;
+    if (p->opts.bin) strcat(reply, " bin");
+    if (p->opts.multi) strcat(reply, " multi");
+    if (p->opts.stream && want.udp && server_udp > 0) {
+        int port = open_udp(p);
+        if (port > 0 && connect_udp(p, server_udp) == 0) {
+            p->opts.udp = 1;
+            p->opts.udp_port = server_udp;
+            snprintf(reply + strlen(reply), sizeof(reply) - strlen(reply), " udp %d", port);
+        } else {
+            close_udp(p);
+        }
+    }
+    send_msg(p, "%s", reply);
+    return CL_WAIT_COMMAND;
+}
+
+void log_protocol(const Peer *p) {
+    logMessage(LOG_PATH_SC, "[HANDSHAKE] Done with peer %d. Protocol: %s%s%s%s, State: %s", p->id,
+               p->opts.stream ? "stream" : "lock-step", p->opts.udp ? " over UDP" : "",
+               p->opts.bin ? " (binary)" : "", p->opts.multi ? ", all drones" : "",
+               state_to_str(p->state));
 }
 
-/* * The Handshake Logic:
+/* * Client side of the Handshake (the server side is hub_handshake_line()):
  * 1. Server sends "ok" -> Client confirms with "ook".
  * 2. Server sends "size W H" -> Client confirms with "sok W H".
  * 3. Client adapts local window size to match Server.
+ * 4. Optional: Server offers "mode stream" -> Client accepts with "mok stream".
  */
-int protocol_handshake(int mode, int fd, int *w, int *h, int fd_bb_out) {
+int protocol_handshake(Peer *p, int *w, int *h, int fd_bb_out) {
     char buf[BUFSZ];
-    logMessage(LOG_PATH_SC, "[HANDSHAKE] Start Mode: %s", mode == MODE_SERVER ? "SERVER" : "CLIENT");
-    
-    if (mode == MODE_SERVER) {
-        send_msg(fd, "ok"); 
-        if (read_line_blocking(fd, buf, sizeof(buf)) <= 0 || strcmp(buf, "ook") != 0) {
-            logMessage(LOG_PATH_SC, "[HANDSHAKE] Error: Expected 'ook', got '%s'", buf);
-            return -1;
-        }
-        send_msg(fd, "size %d %d", *w, *h); 
-        if (read_line_blocking(fd, buf, sizeof(buf)) <= 0 || sscanf(buf, "sok %d %d", w, h) != 2) {
-             logMessage(LOG_PATH_SC, "[HANDSHAKE] Error: Expected 'sok', got '%s'", buf);
-             return -1;
-        }
-    } else {
-        if (read_line_blocking(fd, buf, sizeof(buf)) <= 0 || strcmp(buf, "ok") != 0) {
-            logMessage(LOG_PATH_SC, "[HANDSHAKE] Error: Expected 'ok', got '%s'", buf);
-            return -1;
-        }
-        send_msg(fd, "ook"); 
-        if (read_line_blocking(fd, buf, sizeof(buf)) <= 0 || sscanf(buf, "size %d %d", w, h) != 2) {
-             logMessage(LOG_PATH_SC, "[HANDSHAKE] Error: Expected 'size', got '%s'", buf);
-             return -1;
-        }
-        send_window_size(fd_bb_out, *w, *h);
-        send_msg(fd, "sok %d %d", *w, *h); 
-    }
-    
-    // Set initial state based on Role
-    net_state = (mode == MODE_SERVER) ? SV_SEND_CMD_DRONE : CL_WAIT_COMMAND;
-    logMessage(LOG_PATH_SC, "[HANDSHAKE] Done. State: %s", state_to_str(net_state));
+    logMessage(LOG_PATH_SC, "[HANDSHAKE] Start Mode: CLIENT");
+
+    if (read_line_blocking(p->fd, buf, sizeof(buf)) <= 0 || strcmp(buf, "ok") != 0) {
+        logMessage(LOG_PATH_SC, "[HANDSHAKE] Error: Expected 'ok', got '%s'", buf);
+        return -1;
+    }
+    send_msg(p, "ook");
+    if (read_line_blocking(p->fd, buf, sizeof(buf)) <= 0 || sscanf(buf, "size %d %d", w, h) != 2) {
+         logMessage(LOG_PATH_SC, "[HANDSHAKE] Error: Expected 'size', got '%s'", buf);
+         return -1;
+    }
+    send_window_size(fd_bb_out, *w, *h);
+    send_msg(p, "sok %d %d", *w, *h);
+
+    int first = negotiate_client(p);
+    if (first < 0) return -1;
+    p->state = (NetState)first;
+
+    wire_w = *w;
+    wire_h = *h;
+    log_protocol(p);
     return 0;
 }
 
@@ -346,36 +685,127 @@ int protocol_handshake(int mode, int fd, int *w, int *h, int fd_bb_out) {
 /* * ======================================================================================
  * MACRO-SECTION 5: MAIN LOGIC LOOP (STATE MACHINE)
  * ======================================================================================
- * The core loop that multiplexes between Network I/O and Blackboard I/O using select().
- * Implements the NetState state machine.
+ * The lock-step exchange. lockstep_step() advances the NetState state machine of one
+ * peer on the lines buffered so far. The client runs it from network_loop(), which
+ * multiplexes between Network I/O and Blackboard I/O using select(); the server
+ * from its event loop, for each lock-step session.
  */
 
-void network_loop(int mode, int fd_bb_in, int fd_bb_out) {
+/* Returns -1 when the session ends (the peer quit) */
+int lockstep_step(Peer *p, int fd_bb_out) {
     char net_line[BUFSZ];
-    
-    // Logic Variables
-    float rx, ry; 
-    float vx, vy; 
-    float remote_x, remote_y;
-    Message msg; 
+    float rx, ry;
+    float vx, vy;
+
+    int state_changed;
+    do {
+        state_changed = 0;
+        switch (p->state) {
+            // --- SERVER LOGIC ---
+            case SV_SEND_CMD_DRONE:
+                if (log_traffic) logMessage(LOG_PATH_SC, "[SV] >> Sending 'drone'");
+                send_msg(p, "drone");
+                p->state = SV_SEND_DATA_DRONE;
+                state_changed = 1;
+                break;
+            case SV_SEND_DATA_DRONE:
+                // Convert Local to Virtual coords for transmission
+                local_to_virt(my_last_x, my_last_y, &vx, &vy);
+                send_msg(p, "%f %f", vx, vy);
+                p->state = SV_WAIT_DOK;
+                break;
+            case SV_WAIT_DOK:
+                if (get_line_from_buffer(p, net_line, sizeof(net_line))) {
+                    if (sscanf(net_line, "dok %f %f", &rx, &ry) == 2) {
+                        if (log_traffic) logMessage(LOG_PATH_SC, "[SV] << ACK 'dok'");
+                        p->state = SV_SEND_CMD_OBST;
+                        state_changed = 1;
+                    } else if (strcmp(net_line, "q") == 0) return -1;
+                }
+                break;
+            case SV_SEND_CMD_OBST:
+                send_msg(p, "obst");
+                p->state = SV_WAIT_DATA_OBST;
+                break;
+            case SV_WAIT_DATA_OBST:
+                if (get_line_from_buffer(p, net_line, sizeof(net_line))) {
+                    if (sscanf(net_line, "%f %f", &rx, &ry) == 2) {
+                        if (log_traffic) logMessage(LOG_PATH_SC, "[SV] << Obst Data");
+                        // Forward to Blackboard (Remote Virtual -> Local for display, stamped on arrival)
+                        peer_position(p, rx, ry, now_ms(), fd_bb_out);
+
+                        send_msg(p, "pok %f %f", rx, ry);
+                        p->state = SV_SEND_CMD_DRONE;
+                        state_changed = 1;
+                    }
+                }
+                break;
+
+            // --- CLIENT LOGIC ---
+            case CL_WAIT_COMMAND:
+                if (get_line_from_buffer(p, net_line, sizeof(net_line))) {
+                    if (strcmp(net_line, "drone") == 0) {
+                        p->state = CL_WAIT_DRONE_DATA;
+                        state_changed = 1;
+                    } else if (strcmp(net_line, "obst") == 0) {
+                        p->state = CL_SEND_OBST_DATA;
+                        state_changed = 1;
+                    } else if (strcmp(net_line, "q") == 0) {
+                        send_msg(p, "qok");
+                        return -1;
+                    }
+                }
+                break;
+            case CL_WAIT_DRONE_DATA:
+                if (get_line_from_buffer(p, net_line, sizeof(net_line))) {
+                    if (sscanf(net_line, "%f %f", &rx, &ry) == 2) {
+                        // Forward to Blackboard (Remote Virtual -> Local for display, stamped on arrival)
+                        peer_position(p, rx, ry, now_ms(), fd_bb_out);
+
+                        send_msg(p, "dok %f %f", rx, ry);
+                        p->state = CL_WAIT_COMMAND;
+                    }
+                }
+                break;
+            case CL_SEND_OBST_DATA:
+                // Convert Local -> Virtual for transmission
+                local_to_virt(my_last_x, my_last_y, &vx, &vy);
+                send_msg(p, "%f %f", vx, vy);
+                p->state = CL_WAIT_POK;
+                break;
+            case CL_WAIT_POK:
+                if (get_line_from_buffer(p, net_line, sizeof(net_line))) {
+                    if (sscanf(net_line, "pok %f %f", &rx, &ry) == 2) {
+                        p->state = CL_WAIT_COMMAND;
+                        state_changed = 1;
+                    }
+                }
+                break;
+            default: break;
+        }
+    } while (state_changed);
+    return 0;
+}
+
+/* Client side of a lock-step session */
+void network_loop(Peer *p, int fd_bb_in, int fd_bb_out) {
     fd_set read_fds;
-    struct timeval timeout; 
+    struct timeval timeout;
 
-    set_nonblocking(net_fd);
+    set_nonblocking(p->fd);
     set_nonblocking(fd_bb_in);
 
     while (1) {
         // --- 1. Prepare Select ---
         FD_ZERO(&read_fds);
-        FD_SET(net_fd, &read_fds);
+        FD_SET(p->fd, &read_fds);
         FD_SET(fd_bb_in, &read_fds);
-        
-        int max_fd = (net_fd > fd_bb_in) ? net_fd : fd_bb_in;
-        int has_buf = (strchr(sock_buf.data, '\n') != NULL);
-        
+
+        int max_fd = (p->fd > fd_bb_in) ? p->fd : fd_bb_in;
+
         // If we already have a full line in buffer, immediate timeout (0), else wait briefly
         timeout.tv_sec = 0;
-        timeout.tv_usec = has_buf ? 0 : 2000; 
+        timeout.tv_usec = has_line(p) ? 0 : 2000;
 
         if (select(max_fd + 1, &read_fds, NULL, NULL, &timeout) < 0 && errno != EINTR) {
              logMessage(LOG_PATH_SC, "[NET-ERR] Select failed: %s", strerror(errno));
@@ -383,129 +813,780 @@ void network_loop(int mode, int fd_bb_in, int fd_bb_out) {
         }
 
         // --- 2. Handle Inputs ---
-        
-        // Read local position from Blackboard
-        if (FD_ISSET(fd_bb_in, &read_fds)) update_local_position(fd_bb_in);
+
+        // Read local position from Blackboard (on quit, tell the peer and stop)
+        if (FD_ISSET(fd_bb_in, &read_fds) && update_local_position(fd_bb_in) < 0) {
+            send_msg(p, "q");
+            break;
+        }
 
         // Read raw data from Network into buffer
-        if (FD_ISSET(net_fd, &read_fds)) {
-            if (read_socket_chunk(net_fd) == -1) {
+        if (FD_ISSET(p->fd, &read_fds)) {
+            if (read_socket_chunk(p) == -1) {
                 logMessage(LOG_PATH_SC, "[NET] Socket closed.");
-                goto exit_loop;
+                break;
             }
         }
 
         // --- 3. Process State Machine ---
-        int state_changed;
-        do {
-            state_changed = 0;
-            if (mode == MODE_SERVER) {
-                switch (net_state) {
-                    case SV_SEND_CMD_DRONE:
-                        logMessage(LOG_PATH_SC, "[SV] >> Sending 'drone'");
-                        send_msg(net_fd, "drone");
-                        net_state = SV_SEND_DATA_DRONE;
-                        state_changed = 1; 
-                        break;
-                    case SV_SEND_DATA_DRONE:
-                        // Convert Local to Virtual coords for transmission
-                        local_to_virt(my_last_x, my_last_y, &vx, &vy);
-                        send_msg(net_fd, "%f %f", vx, vy);
-                        net_state = SV_WAIT_DOK;
-                        break;
-                    case SV_WAIT_DOK:
-                        if (get_line_from_buffer(net_line, sizeof(net_line))) {
-                            if (sscanf(net_line, "dok %f %f", &rx, &ry) == 2) {
-                                logMessage(LOG_PATH_SC, "[SV] << ACK 'dok'");
-                                net_state = SV_SEND_CMD_OBST;
-                                state_changed = 1;
-                            } else if (strcmp(net_line, "q") == 0) goto exit_loop;
-                        }
-                        break;
-                    case SV_SEND_CMD_OBST:
-                        send_msg(net_fd, "obst");
-                        net_state = SV_WAIT_DATA_OBST;
-                        break;
-                    case SV_WAIT_DATA_OBST:
-                        if (get_line_from_buffer(net_line, sizeof(net_line))) {
-                            if (sscanf(net_line, "%f %f", &rx, &ry) == 2) {
-                                logMessage(LOG_PATH_SC, "[SV] << Obst Data");
-                                msg.type = MSG_TYPE_DRONE;
-                                // Convert Remote Virtual -> Local for display
-                                virt_to_local(rx, ry, &remote_x, &remote_y);
-                                
-                                // Forward to Blackboard
-                                snprintf(msg.data, sizeof(msg.data), "%f %f", remote_x, remote_y);
-                                write(fd_bb_out, &msg, sizeof(msg));
-                                
-                                send_msg(net_fd, "pok %f %f", rx, ry);
-                                net_state = SV_SEND_CMD_DRONE;
-                                state_changed = 1; 
-                            }
-                        }
-                        break;
-                    default: break; 
-                }
-            } else { // CLIENT LOGIC
-                switch (net_state) {
-                    case CL_WAIT_COMMAND:
-                        if (get_line_from_buffer(net_line, sizeof(net_line))) {
-                            if (strcmp(net_line, "drone") == 0) {
-                                net_state = CL_WAIT_DRONE_DATA;
-                                state_changed = 1;
-                            } else if (strcmp(net_line, "obst") == 0) {
-                                net_state = CL_SEND_OBST_DATA;
-                                state_changed = 1;
-                            } else if (strcmp(net_line, "q") == 0) {
-                                send_msg(net_fd, "qok");
-                                goto exit_loop;
-                            }
-                        }
-                        break;
-                    case CL_WAIT_DRONE_DATA:
-                        if (get_line_from_buffer(net_line, sizeof(net_line))) {
-                            if (sscanf(net_line, "%f %f", &rx, &ry) == 2) {
-                                msg.type = MSG_TYPE_DRONE;
-                                // Convert Remote Virtual -> Local for display
-                                virt_to_local(rx, ry, &remote_x, &remote_y);
-                                
-                                // Forward to Blackboard
-                                snprintf(msg.data, sizeof(msg.data), "%f %f", remote_x, remote_y);
-                                write(fd_bb_out, &msg, sizeof(msg));
-                                
-                                send_msg(net_fd, "dok %f %f", rx, ry);
-                                net_state = CL_WAIT_COMMAND;
-                            }
-                        }
-                        break;
-                    case CL_SEND_OBST_DATA:
-                        // Convert Local -> Virtual for transmission
-                        local_to_virt(my_last_x, my_last_y, &vx, &vy);
-                        send_msg(net_fd, "%f %f", vx, vy);
-                        net_state = CL_WAIT_POK;
-                        break;
-                    case CL_WAIT_POK:
-                        if (get_line_from_buffer(net_line, sizeof(net_line))) {
-                            if (sscanf(net_line, "pok %f %f", &rx, &ry) == 2) {
-                                net_state = CL_WAIT_COMMAND;
-                                state_changed = 1; 
-                            }
-                        }
-                        break;
-                    default: break; 
-                }
+        peer_flush(p);
+        if (lockstep_step(p, fd_bb_out) < 0) break;
+    }
+
+    if (p->fd >= 0) close(p->fd);
+    logMessage(LOG_PATH_SC, "[NET] Loop finished.");
+}
+
+
+/* * ======================================================================================
+ * MACRO-SECTION 6: STREAMING PROTOCOL
+ * ======================================================================================
+ * Negotiated alternative to the lock-step exchange. Both sides push their own state
+ * at NET_STREAM_HZ, without waiting for each other:
+ *
+ *     st <seq> <ack> <t_ms> <x> <y>
+ *
+ * seq numbers this side's updates, ack is the newest seq received from the peer
+ * (cumulative, piggybacked on every update), t_ms is the sender's clock when the
+ * sample was taken and x y are virtual coordinates. A peer position arrives half an
+ * RTT after it was sent and nothing waits for a round trip. The ack bounds the
+ * updates in flight to NET_STREAM_WINDOW, so a slow peer never gets a backlog of
+ * stale positions queued in the socket, and measures the round-trip time.
+ *
+ * With "udp" negotiated, every update is one datagram and the TCP connection only
+ * carries the quit exchange. A lost datagram is never resent: the next update
+ * supersedes it. Anything older than the newest update received (reordered or
+ * duplicated) is dropped, and the seq gaps count the updates that never arrived.
+ * NET_UDP_LOSS drops that percentage of the outgoing datagrams, for loss tests.
+ *
+ * With "bin" negotiated, updates and the quit exchange are binary frames instead
+ * of text lines: a type byte, a payload length byte and the payload, little endian.
+ * A state update is 12 bytes (a text line is about 38):
+ *
+ *     BIN_STATE 10 | seq u16 | ack u16 | t_ms u16 | x u16 | y u16
+ *
+ * seq, ack and t_ms are the low 16 bits of the sender's counters. The receiver
+ * extends seq and ack to the nearest value of its own copy, and t_ms to the
+ * nearest value of its own session clock: both ends start theirs within a round
+ * trip of each other, so it stays right after any silence (a 16-bit copy of the
+ * last update would not past 32.8 s). x and
+ * y are fixed-point, 0..65535 over the "size W H" of the handshake (W/65535 cells
+ * per step, about 0.002 on a 120-column window).
+ *
+ * With "multi" negotiated, the server also sends the other clients' drones, always
+ * on the TCP connection (MACRO-SECTION 7):
+ *
+ *     pe <id> <t_ms> <x> <y>    BIN_PEER 8 | id u16 | t_ms u16 | x u16 | y u16
+ *     pg <id>                   BIN_PEER_GONE 2 | id u16
+ *
+ * t_ms is when the server received that position, on the same clock as the
+ * server's own "st" updates to this client, so the receiver can space the samples
+ * of every drone as they were taken rather than as the batches arrived.
+ */
+
+#define BIN_STATE    1
+#define BIN_QUIT     2    // Same meaning as the "q" / "qok" lines
+#define BIN_QUIT_OK  3
+#define BIN_PEER     4    // Same meaning as the "pe" / "pg" lines
+#define BIN_PEER_GONE 5
+#define BIN_HDR      2
+#define BIN_STATE_LEN 10
+#define BIN_PEER_LEN 8
+#define BIN_FRAME_MAX (BIN_HDR + 255)
+
+// --- Binary frames ---
+
+static void put_u16(uint8_t *p, unsigned v) {
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+}
+
+static unsigned get_u16(const uint8_t *p) {
+    return p[0] | (p[1] << 8);
+}
+
+/* Full 32-bit value nearest to `ref` whose low 16 bits are `low` */
+static uint32_t extend_u16(uint32_t ref, unsigned low) {
+    return ref + (int16_t)(uint16_t)(low - (ref & 0xffff));
+}
+
+/* Peer clock of a 16-bit t_ms: nearest to our own time since stream_start */
+static long session_clock(const Peer *p, unsigned low) {
+    return (int32_t)extend_u16((uint32_t)(now_ms() - p->st.t0), low);
+}
+
+static unsigned quantize(float v, int extent) {
+    if (extent <= 0 || v <= 0.0f) return 0;
+    if (v >= extent) return 65535;
+    return (unsigned)lrintf(v * 65535.0f / extent);
+}
+
+static float dequantize(unsigned q, int extent) {
+    return q * (float)extent / 65535.0f;
+}
+
+/* * Extracts one binary frame from the peer's buffer (TCP side, frames may be split).
+ * Returns the payload length, or -1 if the frame is not complete yet.
+ */
+int get_frame_from_buffer(Peer *p, uint8_t *type, uint8_t *payload) {
+    SocketBuffer *sb = &p->in;
+    if (sb->len < BIN_HDR) return -1;
+    const uint8_t *f = (const uint8_t *)sb->data;
+    int len = f[1];
+    if (sb->len < BIN_HDR + len) return -1;
+
+    *type = f[0];
+    memcpy(payload, f + BIN_HDR, len);
+    sb->len -= BIN_HDR + len;
+    memmove(sb->data, sb->data + BIN_HDR + len, sb->len);
+    return len;
+}
+
+int send_frame(Peer *p, uint8_t type) {
+    uint8_t f[BIN_HDR] = { type, 0 };
+    return peer_write(p, f, sizeof(f));
+}
+
+/* * Writes the "pe" line / BIN_PEER frame of `from`'s drone for peer `to` (at most
+ * NET_PEER_RECORD_MAX bytes); returns its length, 0 if it did not fit.
+ */
+int encode_peer(const Peer *to, char *buf, const Peer *from) {
+    long t_ms = from->rx_ms - to->st.t0;
+    if (!to->opts.bin) {
+        int n = snprintf(buf, NET_PEER_RECORD_MAX, "pe %d %ld %f %f\n", from->id, t_ms, from->vx, from->vy);
+        return n > 0 && n < NET_PEER_RECORD_MAX ? n : 0;
+    }
+    uint8_t *f = (uint8_t *)buf;
+    f[0] = BIN_PEER;
+    f[1] = BIN_PEER_LEN;
+    put_u16(f + 2, from->id);
+    put_u16(f + 4, (unsigned)t_ms);
+    put_u16(f + 6, quantize(from->vx, wire_w));
+    put_u16(f + 8, quantize(from->vy, wire_h));
+    return BIN_HDR + BIN_PEER_LEN;
+}
+
+int send_peer_gone(Peer *to, int id) {
+    if (!to->opts.bin) return send_msg(to, "pg %d", id);
+    uint8_t f[BIN_HDR + 2] = { BIN_PEER_GONE, 2 };
+    put_u16(f + 2, id);
+    return peer_write(to, f, sizeof(f));
+}
+
+// --- Updates ---
+
+/* * Puts one encoded update on the wire (TCP stream or one datagram).
+ * Returns -1 if the TCP connection failed.
+ */
+int stream_send(Peer *p, const void *buf, int len) {
+    StreamState *st = &p->st;
+    if (p->udp_fd < 0) {
+        if (peer_write(p, buf, len) < 0) return -1;
+    } else if (st->loss_pct > 0 && rand() % 100 < st->loss_pct) {
+        st->dropped++;
+        return 0;
+    } else if (send(p->udp_fd, buf, len, 0) < 0 && errno != EAGAIN && errno != ECONNREFUSED) {
+        logMessage(LOG_PATH_SC, "[NET] ERROR sending datagram: %s", strerror(errno));
+    }
+    st->bytes_tx += len;
+    return 0;
+}
+
+/* * One tick: push our position if it changed (window permitting) or if the peer's
+ * updates need an ack. Returns -1 if the TCP connection failed.
+ */
+int stream_tick(Peer *p) {
+    StreamState *st = &p->st;
+    int changed = st->seq == 0 || my_last_x != st->sent_x || my_last_y != st->sent_y;
+    int owe_ack = st->acked_peer != st->peer_seq;
+    long now = now_ms();
+    if (!changed && !owe_ack) return 0;
+    if (changed && !owe_ack && st->seq - st->peer_acked >= NET_STREAM_WINDOW &&
+        now - st->last_tx_ms < NET_STREAM_PROBE_MS) {
+        st->window_full++;
+        return 0;
+    }
+
+    float vx, vy;
+    local_to_virt(my_last_x, my_last_y, &vx, &vy);
+    st->seq++;
+    st->sent_ms[st->seq % NET_STREAM_WINDOW] = now;
+    st->last_tx_ms = now;
+
+    int r;
+    if (p->opts.bin) {
+        uint8_t f[BIN_HDR + BIN_STATE_LEN] = { BIN_STATE, BIN_STATE_LEN };
+        put_u16(f + 2, st->seq);
+        put_u16(f + 4, st->peer_seq);
+        put_u16(f + 6, (unsigned)(now - st->t0));
+        put_u16(f + 8, quantize(vx, wire_w));
+        put_u16(f + 10, quantize(vy, wire_h));
+        r = stream_send(p, f, sizeof(f));
+    } else {
+        char line[128];
+        int len = snprintf(line, sizeof(line), "st %u %u %ld %f %f%s", st->seq, st->peer_seq,
+                           now - st->t0, vx, vy, p->udp_fd < 0 ? "\n" : "");
+        r = stream_send(p, line, len);
+    }
+    st->sent_x = my_last_x;
+    st->sent_y = my_last_y;
+    st->acked_peer = st->peer_seq;
+    st->tx++;
+    return r;
+}
+
+/* A decoded peer update: forwards the position unless an update at least as new was seen */
+void stream_apply(Peer *p, uint32_t seq, uint32_t ack, long t_ms, float rx, float ry, int fd_bb_out) {
+    StreamState *st = &p->st;
+
+    if (ack > st->peer_acked && ack <= st->seq) {
+        if (st->seq - ack < NET_STREAM_WINDOW) {
+            st->rtt_sum += now_ms() - st->sent_ms[ack % NET_STREAM_WINDOW];
+            st->rtt_count++;
+        }
+        st->peer_acked = ack;
+    }
+    if (seq <= st->peer_seq) {
+        st->stale++;
+        return;
+    }
+    st->missed += seq - st->peer_seq - 1;
+    st->peer_seq = seq;
+    st->rx++;
+
+    peer_position(p, rx, ry, t_ms, fd_bb_out);
+}
+
+/* One "st" text line from the peer */
+void stream_receive(Peer *p, const char *line, int fd_bb_out) {
+    unsigned int seq, ack;
+    long t_ms;
+    float rx, ry;
+    if (sscanf(line, "st %u %u %ld %f %f", &seq, &ack, &t_ms, &rx, &ry) != 5) return;
+    stream_apply(p, seq, ack, t_ms, rx, ry, fd_bb_out);
+}
+
+/* One BIN_STATE payload from the peer */
+void stream_receive_bin(Peer *p, const uint8_t *d, int len, int fd_bb_out) {
+    StreamState *st = &p->st;
+    if (len != BIN_STATE_LEN) return;
+    uint32_t seq = extend_u16(st->peer_seq, get_u16(d));
+    uint32_t ack = extend_u16(st->seq, get_u16(d + 2));
+    long t_ms = session_clock(p, get_u16(d + 4));
+    stream_apply(p, seq, ack, t_ms, dequantize(get_u16(d + 6), wire_w), dequantize(get_u16(d + 8), wire_h), fd_bb_out);
+}
+
+void stream_log_stats(const Peer *p) {
+    const StreamState *st = &p->st;
+    unsigned long sent = st->tx - st->dropped;
+    logMessage(LOG_PATH_SC, "[NET] Stream with peer %d: %lu updates sent (%lu dropped on purpose, %.1f bytes each), "
+               "%lu received (%lu stale, %lu missed, %lu rejected), window full %lu times, rtt %.2f ms", p->id,
+               st->tx, st->dropped, sent ? (double)st->bytes_tx / sent : 0.0,
+               st->rx, st->stale, st->missed, st->rejected, st->window_full,
+               st->rtt_count ? st->rtt_sum / st->rtt_count : 0.0);
+}
+
+/* Every datagram waiting on the UDP socket, one update each */
+void stream_receive_udp(Peer *p, int fd_bb_out) {
+    char dgram[BIN_FRAME_MAX + 1];
+    ssize_t n;
+    while ((n = recv(p->udp_fd, dgram, sizeof(dgram) - 1, MSG_DONTWAIT)) >= 0) {
+        if (p->opts.bin) {
+            const uint8_t *f = (const uint8_t *)dgram;
+            if (n >= BIN_HDR && f[0] == BIN_STATE && n == BIN_HDR + f[1])
+                stream_receive_bin(p, f + BIN_HDR, f[1], fd_bb_out);
+        } else {
+            dgram[n] = '\0';
+            stream_receive(p, dgram, fd_bb_out);
+        }
+    }
+}
+
+/* Another client's drone ("multi", client side) */
+void stream_receive_peer(int id, long t_ms, float rx, float ry, int fd_bb_out) {
+    if (wire_position(&rx, &ry) < 0) return;
+    forward_drone(fd_bb_out, id, rx, ry, t_ms);
+}
+
+/* * Everything complete in the TCP buffer: updates, the other drones ("multi",
+ * client side) and the peer's quit. Returns 1 when the peer quits. The server
+ * shares this with its clients, and rejects any drone records they send: a
+ * client could otherwise move or remove other clients' drones.
+ */
+int stream_drain_tcp(Peer *p, int fd_bb_out) {
+    int from_client = p != &net_peer;
+    if (p->opts.bin) {
+        uint8_t type, payload[BIN_FRAME_MAX];
+        int len;
+        while ((len = get_frame_from_buffer(p, &type, payload)) >= 0) {
+            if (type == BIN_STATE) stream_receive_bin(p, payload, len, fd_bb_out);
+            else if ((type == BIN_PEER || type == BIN_PEER_GONE) && from_client) p->st.rejected++;
+            else if (type == BIN_PEER && len == BIN_PEER_LEN && p->opts.multi)
+                stream_receive_peer(get_u16(payload), session_clock(p, get_u16(payload + 2)),
+                                    dequantize(get_u16(payload + 4), wire_w), dequantize(get_u16(payload + 6), wire_h), fd_bb_out);
+            else if (type == BIN_PEER_GONE && len == 2 && p->opts.multi)
+                forward_drone_gone(fd_bb_out, get_u16(payload));
+            else if (type == BIN_QUIT) {
+                send_frame(p, BIN_QUIT_OK);
+                return 1;
             }
-        } while (state_changed);
+        }
+        return 0;
+    }
+
+    char net_line[BUFSZ];
+    int id;
+    long t_ms;
+    float rx, ry;
+    while (get_line_from_buffer(p, net_line, sizeof(net_line))) {
+        if (strcmp(net_line, "q") == 0) {
+            send_msg(p, "qok");
+            return 1;
+        }
+        if (from_client && (strncmp(net_line, "pe ", 3) == 0 || strncmp(net_line, "pg ", 3) == 0))
+            p->st.rejected++;
+        else if (p->opts.multi && sscanf(net_line, "pe %d %ld %f %f", &id, &t_ms, &rx, &ry) == 4)
+            stream_receive_peer(id, t_ms, rx, ry, fd_bb_out);
+        else if (p->opts.multi && sscanf(net_line, "pg %d", &id) == 1) forward_drone_gone(fd_bb_out, id);
+        else stream_receive(p, net_line, fd_bb_out);
+    }
+    return 0;
+}
+
+/* Tick period in ms (NET_STREAM_HZ) */
+long stream_period_ms(void) {
+    int hz = param_int("NET_STREAM_HZ", NET_STREAM_HZ_DEFAULT);
+    if (hz < 1) hz = 1;
+    if (hz > 1000) hz = 1000;
+    return 1000 / hz;
+}
+
+/* Session start: clock origin, loss injection, no Nagle delay on the small updates */
+void stream_start(Peer *p) {
+    memset(&p->st, 0, sizeof(p->st));
+    if (p->udp_fd >= 0) p->st.loss_pct = param_int("NET_UDP_LOSS", 0);
+    p->st.t0 = now_ms();
+    int one = 1;
+    setsockopt(p->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+/* Client side of a stream session */
+void stream_loop(Peer *p, int fd_bb_in, int fd_bb_out) {
+    long period = stream_period_ms();
+
+    set_nonblocking(p->fd);
+    set_nonblocking(fd_bb_in);
+    log_traffic = 0;
+    stream_start(p);
+
+    long next_tick = p->st.t0, next_stats = p->st.t0 + NET_STATS_PERIOD_MS;
+    logMessage(LOG_PATH_SC, "[NET] Streaming at %ld Hz over %s, %s frames (injected loss %d%%)",
+               1000 / period, p->udp_fd >= 0 ? "UDP" : "TCP", p->opts.bin ? "binary" : "text", p->st.loss_pct);
+
+    while (1) {
+        long now = now_ms();
+        long wait = next_tick > now ? next_tick - now : 0;
+        fd_set read_fds, write_fds;
+        FD_ZERO(&read_fds);
+        FD_ZERO(&write_fds);
+        FD_SET(p->fd, &read_fds);
+        FD_SET(fd_bb_in, &read_fds);
+        if (p->out.len > 0) FD_SET(p->fd, &write_fds);
+        if (p->udp_fd >= 0) FD_SET(p->udp_fd, &read_fds);
+        struct timeval timeout = { .tv_sec = wait / 1000, .tv_usec = (wait % 1000) * 1000 };
+        int max_fd = (p->fd > fd_bb_in) ? p->fd : fd_bb_in;
+        if (p->udp_fd > max_fd) max_fd = p->udp_fd;
+
+        if (select(max_fd + 1, &read_fds, &write_fds, NULL, &timeout) < 0) {
+            if (errno == EINTR) continue;
+            logMessage(LOG_PATH_SC, "[NET-ERR] Select failed: %s", strerror(errno));
+            break;
+        }
+
+        if (FD_ISSET(fd_bb_in, &read_fds) && update_local_position(fd_bb_in) < 0) {
+            if (p->opts.bin) send_frame(p, BIN_QUIT);
+            else send_msg(p, "q");
+            break;
+        }
+        if (FD_ISSET(p->fd, &write_fds) && peer_flush(p) < 0) break;
+        if (FD_ISSET(p->fd, &read_fds) && read_socket_chunk(p) == -1) {
+            logMessage(LOG_PATH_SC, "[NET] Socket closed.");
+            break;
+        }
+        if (stream_drain_tcp(p, fd_bb_out)) break;
+        if (p->udp_fd >= 0 && FD_ISSET(p->udp_fd, &read_fds)) stream_receive_udp(p, fd_bb_out);
+
+        now = now_ms();
+        if (now >= next_tick) {
+            stream_tick(p);
+            next_tick += period;
+            if (next_tick <= now) next_tick = now + period;   // Late: skip, do not burst
+        }
+        if (now >= next_stats) {
+            stream_log_stats(p);
+            next_stats = now + NET_STATS_PERIOD_MS;
+        }
     }
 
-exit_loop:
-    if (net_fd >= 0) close(net_fd);
+    stream_log_stats(p);
+    close_udp(p);
+    if (p->fd >= 0) close(p->fd);
     logMessage(LOG_PATH_SC, "[NET] Loop finished.");
 }
 
 
 /* * ======================================================================================
- * MACRO-SECTION 6: MAIN ENTRY POINT
+ * MACRO-SECTION 7: MULTI-CLIENT SERVER
+ * ======================================================================================
+ * The server accepts any number of clients (up to NET_MAX_CLIENTS) on its
+ * non-blocking listening socket, all served by one epoll loop. Every client is a
+ * Peer with its own buffers, options and protocol state, so each session speaks
+ * whatever it negotiated (lock-step, text or binary stream, TCP or UDP), and
+ * nothing blocks: the handshake is a per-session state machine as well.
+ *
+ * Every client's drone is shown on the server's Blackboard as remote drone `id`.
+ * Clients that negotiated "multi" also get all the other clients' drones: on each
+ * stream tick, a client receives one batch with the drones that moved since its
+ * previous batch (one write, however many drones). A client whose socket has not
+ * drained the previous batch is skipped for that tick and gets the newer positions
+ * in its next batch, so a slow client costs itself one round, never a queue and
+ * never a stall for the others. One whose socket stays full for NET_STALL_MS has
+ * stopped reading and is dropped.
+ */
+
+typedef struct {
+    int listen_fd, epfd;
+    int fd_bb_in, fd_bb_out;
+    Peer **peers;
+    int num_peers, max_peers;
+    int next_id;
+    uint8_t id_used[(NET_ID_MAX + 1) / 8];   // Ids of the connected clients, one bit each
+    unsigned long batches, skipped, fanout_bytes, gone;
+} Hub;
+
+// epoll tags of the two descriptors that are not peers
+static int tag_listen, tag_blackboard;
+
+/* Registers EPOLLOUT on the peer's socket only while output is pending */
+void hub_watch_out(Hub *hub, Peer *p) {
+    int want = p->out.len > 0;
+    if (p->dead || want == p->watch_out) return;
+    struct epoll_event ev = { .events = EPOLLIN | (want ? EPOLLOUT : 0), .data.ptr = p };
+    epoll_ctl(hub->epfd, EPOLL_CTL_MOD, p->fd, &ev);
+    p->watch_out = want;
+}
+
+void hub_kill(Peer *p, const char *why) {
+    if (p->dead) return;
+    logMessage(LOG_PATH_SC, "[HUB] Client %d: %s", p->id, why);
+    p->dead = 1;
+}
+
+/* * Next free client id, round robin over 1..NET_ID_MAX: an id comes back only
+ * after its client left, so two live clients never share one. There are far
+ * fewer clients (NET_MAX_CLIENTS_LIMIT) than ids, so the search always ends.
+ */
+static int hub_take_id(Hub *hub) {
+    while (hub->id_used[hub->next_id / 8] & (1 << (hub->next_id % 8))) {
+        if (++hub->next_id > NET_ID_MAX) hub->next_id = 1;
+    }
+    int id = hub->next_id;
+    hub->id_used[id / 8] |= 1 << (id % 8);
+    if (++hub->next_id > NET_ID_MAX) hub->next_id = 1;
+    return id;
+}
+
+static void hub_release_id(Hub *hub, int id) {
+    hub->id_used[id / 8] &= ~(1 << (id % 8));
+}
+
+/* New connections, until the backlog is empty */
+void hub_accept(Hub *hub) {
+    while (1) {
+        struct sockaddr_in cli;
+        socklen_t len = sizeof(cli);
+        int fd = accept(hub->listen_fd, (struct sockaddr*)&cli, &len);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                logMessage(LOG_PATH_SC, "[NET-ERR] Accept failed: %s", strerror(errno));
+            return;
+        }
+        if (hub->num_peers == hub->max_peers) {
+            logMessage(LOG_PATH_SC, "[HUB] Refused %s: %d clients already", inet_ntoa(cli.sin_addr), hub->max_peers);
+            close(fd);
+            continue;
+        }
+
+        Peer *p = calloc(1, sizeof(Peer));
+        if (!p) {
+            close(fd);
+            continue;
+        }
+        set_nonblocking(fd);
+        p->fd = fd;
+        p->udp_fd = -1;
+        p->state = SV_WAIT_OOK;
+        p->deadline_ms = now_ms() + NET_HANDSHAKE_MS;
+
+        struct epoll_event ev = { .events = EPOLLIN, .data.ptr = p };
+        if (epoll_ctl(hub->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            free(p);
+            continue;
+        }
+        p->id = hub_take_id(hub);
+        hub->peers[hub->num_peers++] = p;
+        logMessage(LOG_PATH_SC, "[NET-SRV] Accepted connection from %s as client %d (%d connected)",
+                   inet_ntoa(cli.sin_addr), p->id, hub->num_peers);
+        send_msg(p, "ok");
+    }
+}
+
+/* The handshake is over: start the negotiated protocol */
+void hub_start_session(Hub *hub, Peer *p) {
+    if (p->opts.stream) {
+        p->state = SV_STREAM;
+        stream_start(p);
+        if (p->udp_fd >= 0) {
+            // Same tag as the TCP socket: an event on either reads both
+            struct epoll_event ev = { .events = EPOLLIN, .data.ptr = p };
+            epoll_ctl(hub->epfd, EPOLL_CTL_ADD, p->udp_fd, &ev);
+        }
+    } else {
+        p->state = SV_SEND_CMD_DRONE;
+    }
+    log_protocol(p);
+    if (!p->opts.stream && lockstep_step(p, hub->fd_bb_out) < 0) hub_kill(p, "quit");
+}
+
+/* * Server side of the Handshake, one line at a time:
+ * 1. Server sends "ok" -> Client confirms with "ook".
+ * 2. Server sends "size W H" -> Client confirms with "sok W H".
+ * 3. Optional: Server offers "mode stream ..." -> Client accepts with "mok stream ...".
+ */
+void hub_handshake_line(Hub *hub, Peer *p, char *line) {
+    switch (p->state) {
+        case SV_WAIT_OOK:
+            if (strcmp(line, "ook") != 0) {
+                logMessage(LOG_PATH_SC, "[HANDSHAKE] Error: Expected 'ook', got '%s'", line);
+                hub_kill(p, "handshake failed");
+                return;
+            }
+            send_msg(p, "size %d %d", wire_w, wire_h);
+            p->state = SV_WAIT_SOK;
+            break;
+        case SV_WAIT_SOK: {
+            int w, h;
+            if (sscanf(line, "sok %d %d", &w, &h) != 2) {
+                logMessage(LOG_PATH_SC, "[HANDSHAKE] Error: Expected 'sok', got '%s'", line);
+                hub_kill(p, "handshake failed");
+                return;
+            }
+            if (offer_options(p)) {
+                p->state = SV_WAIT_MOK;
+                p->deadline_ms = now_ms() + NET_NEGOTIATE_MS;
+            } else {
+                hub_start_session(hub, p);
+            }
+            break;
+        }
+        case SV_WAIT_MOK:
+            accept_options(p, line);
+            hub_start_session(hub, p);
+            break;
+        default: break;
+    }
+}
+
+/* Input on one of the peer's sockets (both are read: they share the epoll tag) */
+void hub_peer_input(Hub *hub, Peer *p) {
+    char line[BUFSZ];
+    if (read_socket_chunk(p) < 0) {
+        hub_kill(p, "disconnected");
+        return;
+    }
+
+    while (!p->dead && in_handshake(p) && get_line_from_buffer(p, line, sizeof(line)))
+        hub_handshake_line(hub, p, line);
+
+    if (!p->dead && p->state == SV_STREAM) {
+        if (p->udp_fd >= 0) stream_receive_udp(p, hub->fd_bb_out);
+        if (stream_drain_tcp(p, hub->fd_bb_out)) hub_kill(p, "quit");
+    } else if (!p->dead && !in_handshake(p) && lockstep_step(p, hub->fd_bb_out) < 0) {
+        hub_kill(p, "quit");
+    }
+
+    // A full buffer that nothing could parse would keep the socket ready forever
+    if (!p->dead && p->in.len >= BUFSZ - 1) hub_kill(p, "unparsable input");
+}
+
+/* * Fan-out round: each "multi" client gets, in one write, every other drone that
+ * moved since its last batch. Clients still draining their socket wait a round.
+ */
+void hub_fanout(Hub *hub) {
+    static char batch[NET_OUTBUF];
+    // One record of at most NET_PEER_RECORD_MAX bytes per other client: max_peers keeps that within the batch
+    assert(hub->num_peers <= NET_MAX_CLIENTS_LIMIT);
+    for (int i = 0; i < hub->num_peers; i++) {
+        Peer *q = hub->peers[i];
+        if (q->dead || q->state != SV_STREAM || !q->opts.multi) continue;
+        if (q->out.len > 0) {
+            hub->skipped++;
+            if (now_ms() - q->stalled_ms >= NET_STALL_MS) hub_kill(q, "not reading, dropped");
+            continue;
+        }
+
+        int len = 0;
+        for (int j = 0; j < hub->num_peers; j++) {
+            Peer *p = hub->peers[j];
+            if (p == q || p->dead || p->moved <= q->synced) continue;
+            len += encode_peer(q, batch + len, p);
+        }
+        q->synced = hub_epoch;
+        if (len == 0) continue;
+        if (peer_write(q, batch, len) < 0) hub_kill(q, "send failed");
+        hub->batches++;
+        hub->fanout_bytes += len;
+    }
+    hub_epoch++;
+}
+
+/* Stream tick: our own drone to every stream session, handshake timeouts, then the fan-out round */
+void hub_tick(Hub *hub) {
+    long now = now_ms();
+    for (int i = 0; i < hub->num_peers; i++) {
+        Peer *p = hub->peers[i];
+        if (p->dead) continue;
+        if (p->state == SV_STREAM) {
+            if (stream_tick(p) < 0) hub_kill(p, "send failed");
+        } else if (p->state == SV_WAIT_MOK && now >= p->deadline_ms) {
+            accept_options(p, NULL);
+            hub_start_session(hub, p);
+        } else if (in_handshake(p) && now >= p->deadline_ms) {
+            hub_kill(p, "handshake timed out");
+        }
+    }
+    hub_fanout(hub);
+}
+
+/* * Frees the peers closed during the last event batch. The Blackboard and every
+ * "multi" client that may have seen the drone are told it is gone.
+ */
+void hub_reap(Hub *hub) {
+    for (int i = 0; i < hub->num_peers; i++) {
+        Peer *p = hub->peers[i];
+        if (!p->dead) continue;
+
+        if (p->moved) {
+            forward_drone_gone(hub->fd_bb_out, p->id);
+            for (int j = 0; j < hub->num_peers; j++) {
+                Peer *q = hub->peers[j];
+                if (q->dead || q->state != SV_STREAM || !q->opts.multi) continue;
+                if (send_peer_gone(q, p->id) < 0) hub_kill(q, "send failed");
+            }
+        }
+        if (p->state == SV_STREAM) stream_log_stats(p);
+        if (p->udp_fd >= 0) epoll_ctl(hub->epfd, EPOLL_CTL_DEL, p->udp_fd, NULL);
+        epoll_ctl(hub->epfd, EPOLL_CTL_DEL, p->fd, NULL);
+        close_udp(p);
+        close(p->fd);
+        hub_release_id(hub, p->id);
+        free(p);
+        hub->peers[i--] = hub->peers[--hub->num_peers];
+        hub->gone++;
+    }
+}
+
+void hub_log_stats(const Hub *hub) {
+    int streaming = 0;
+    for (int i = 0; i < hub->num_peers; i++) streaming += hub->peers[i]->state == SV_STREAM;
+    logMessage(LOG_PATH_SC, "[HUB] %d clients (%d streaming), %lu batches sent (%lu bytes), "
+               "%lu skipped while draining, %lu clients gone",
+               hub->num_peers, streaming, hub->batches, hub->fanout_bytes, hub->skipped, hub->gone);
+}
+
+void hub_loop(int listen_fd, int fd_bb_in, int fd_bb_out) {
+    Hub hub = { .listen_fd = listen_fd, .fd_bb_in = fd_bb_in, .fd_bb_out = fd_bb_out, .next_id = 1 };
+    hub.max_peers = param_int("NET_MAX_CLIENTS", NET_MAX_CLIENTS_DEFAULT);
+    if (hub.max_peers < 1) hub.max_peers = 1;
+    if (hub.max_peers > NET_MAX_CLIENTS_LIMIT) hub.max_peers = NET_MAX_CLIENTS_LIMIT;
+    hub.peers = calloc(hub.max_peers, sizeof(Peer *));
+    hub.epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (!hub.peers || hub.epfd < 0) {
+        logMessage(LOG_PATH_SC, "[NET-ERR] Server loop: %s", strerror(errno));
+        free(hub.peers);
+        return;
+    }
+
+    set_nonblocking(fd_bb_in);
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = &tag_listen };
+    epoll_ctl(hub.epfd, EPOLL_CTL_ADD, listen_fd, &ev);
+    ev.data.ptr = &tag_blackboard;
+    epoll_ctl(hub.epfd, EPOLL_CTL_ADD, fd_bb_in, &ev);
+    log_traffic = 0;   // Up to hundreds of sessions: stats only
+
+    long period = stream_period_ms();
+    long next_tick = now_ms() + period, next_stats = now_ms() + NET_STATS_PERIOD_MS;
+    logMessage(LOG_PATH_SC, "[HUB] Serving up to %d clients, ticks at %ld Hz", hub.max_peers, 1000 / period);
+
+    struct epoll_event events[NET_EPOLL_EVENTS];
+    int running = 1;
+    while (running) {
+        long now = now_ms();
+        int n = epoll_wait(hub.epfd, events, NET_EPOLL_EVENTS, next_tick > now ? (int)(next_tick - now) : 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            logMessage(LOG_PATH_SC, "[NET-ERR] epoll_wait failed: %s", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            void *tag = events[i].data.ptr;
+            if (tag == &tag_listen) {
+                hub_accept(&hub);
+            } else if (tag == &tag_blackboard) {
+                if (update_local_position(fd_bb_in) < 0) running = 0;
+            } else {
+                Peer *p = tag;
+                if (p->dead) continue;
+                if ((events[i].events & EPOLLOUT) && peer_flush(p) < 0) hub_kill(p, "disconnected");
+                if (!p->dead && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) hub_peer_input(&hub, p);
+            }
+        }
+
+        now = now_ms();
+        if (now >= next_tick) {
+            hub_tick(&hub);
+            next_tick += period;
+            if (next_tick <= now) next_tick = now + period;   // Late: skip, do not burst
+        }
+        if (now >= next_stats) {
+            hub_log_stats(&hub);
+            next_stats = now + NET_STATS_PERIOD_MS;
+        }
+        hub_reap(&hub);
+        for (int i = 0; i < hub.num_peers; i++) hub_watch_out(&hub, hub.peers[i]);
+    }
+
+    // Local quit: tell every client, then close everything
+    for (int i = 0; i < hub.num_peers; i++) {
+        Peer *p = hub.peers[i];
+        if (p->opts.bin) send_frame(p, BIN_QUIT);
+        else send_msg(p, "q");
+        p->moved = 0;   // No "gone" notices: everyone is leaving
+        p->dead = 1;
+    }
+    hub_log_stats(&hub);
+    hub_reap(&hub);
+    free(hub.peers);
+    close(hub.epfd);
+    close(listen_fd);
+    logMessage(LOG_PATH_SC, "[NET] Loop finished.");
+}
+
+
+/* * ======================================================================================
+ * MACRO-SECTION 8: MAIN ENTRY POINT
  * ======================================================================================
  * Arguments parsing, Signal setup, and Initialization.
  */
@@ -515,29 +1596,37 @@ int main(int argc, char *argv[]) {
     if (argc < 6) return 1;
 
     // Parse Arguments
-    int fd_bb_in = atoi(argv[1]);   
-    int fd_bb_out = atoi(argv[2]);  
+    int fd_bb_in = atoi(argv[1]);
+    int fd_bb_out = atoi(argv[2]);
     int mode = atoi(argv[3]);
     const char *addr = (argc > 4) ? argv[4] : "127.0.0.1";
     int port = atoi(argv[5]);
     int w = 100, h = 100;
+    srand(time(NULL) ^ getpid());
 
-    // Initialize Connection
+    // Server: the Window Size from Blackboard is sent to every Client
     if (mode == MODE_SERVER) {
-        // Server needs the Window Size from Blackboard to send to Client
         receive_window_size(fd_bb_in, &w, &h);
-        net_fd = init_server(port);
-    } else {
-        net_fd = init_client(addr, port);
+        wire_w = w;
+        wire_h = h;
+        int listen_fd = init_server(port);
+        if (listen_fd < 0) {
+            logMessage(LOG_PATH_SC, "[NET-FATAL] Init Failed.");
+            return 1;
+        }
+        hub_loop(listen_fd, fd_bb_in, fd_bb_out);
+        return 0;
     }
 
-    // Perform Handshake
-    if (net_fd < 0 || protocol_handshake(mode, net_fd, &w, &h, fd_bb_out) < 0) {
+    // Client: Connection and Handshake
+    net_peer.fd = init_client(addr, port);
+    if (net_peer.fd < 0 || protocol_handshake(&net_peer, &w, &h, fd_bb_out) < 0) {
         logMessage(LOG_PATH_SC, "[NET-FATAL] Init Failed.");
         return 1;
     }
 
     // Start Main Loop
-    network_loop(mode, fd_bb_in, fd_bb_out);
+    if (net_peer.opts.stream) stream_loop(&net_peer, fd_bb_in, fd_bb_out);
+    else network_loop(&net_peer, fd_bb_in, fd_bb_out);
     return 0;
-}
\ No newline at end of file
+}
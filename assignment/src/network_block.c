@@ -165,8 +165,9 @@ int init_client(const char *addr, int port) {
 
 void send_window_size(int fd_out, int w, int h) {
     Message msg;
-    msg.type = MSG_TYPE_SIZE;
-    snprintf(msg.data, sizeof(msg.data), "%d %d", w, h);
+    msg_init(&msg, MSG_TYPE_SIZE);
+    msg.data.size.width = w;
+    msg.data.size.height = h;
     write(fd_out, &msg, sizeof(msg));  
     logMessage(LOG_PATH, "[NET] Sent SIZE %d %d to Blackboard", w, h);  
 }
@@ -181,10 +182,9 @@ void receive_window_size(int fd_in, int *w, int *h){
         return;
     }
     
-    int width, height; 
-    if (sscanf(msg.data, "%d %d", &width, &height) == 2) {
-        *w = width; 
-        *h = height;
+    if (msg_valid(&msg) && msg.type == MSG_TYPE_SIZE) {
+        *w = msg.data.size.width;
+        *h = msg.data.size.height;
         logMessage(LOG_PATH, "[NET] Received window size: %dx%d", *w, *h);
     }
 }
@@ -196,10 +196,9 @@ void receive_drone_position(float *x, float *y, int fd_in){
         logMessage(LOG_PATH, "[NET] Pipe blackboard closed (read drone), exiting.");
         exit(1);
     }
-    float pos_x, pos_y;
-    if (sscanf(msg.data, "%f %f", &pos_x, &pos_y) == 2) {
-        *x = pos_x;
-        *y = pos_y;
+    if (msg_valid(&msg) && msg.type == MSG_TYPE_POSITION) {
+        *x = msg.data.pos.x;
+        *y = msg.data.pos.y;
     }
 }
 
@@ -325,8 +324,9 @@ void network_loop(int mode, int fd_bb_in, int fd_bb_out) {
                         
                         // --- Forward to Blackboard ---
                         // We mark this as MSG_TYPE_DRONE so Blackboard treats it as a remote entity
-                        msg.type = MSG_TYPE_DRONE; 
-                        snprintf(msg.data, sizeof(msg.data), "%f %f", rx, ry);
+                        msg_init(&msg, MSG_TYPE_DRONE);
+                        msg.data.pos.x = rx;
+                        msg.data.pos.y = ry;
                         if(write(fd_bb_out, &msg, sizeof(msg)) < 0) perror("write bb");
                         // -----------------------------
 
@@ -354,8 +354,9 @@ void network_loop(int mode, int fd_bb_in, int fd_bb_out) {
                     if (sscanf(net_buf, "%f %f", &rx, &ry) == 2) {
                         
                         // --- Forward to Blackboard ---
-                        msg.type = MSG_TYPE_DRONE; 
-                        snprintf(msg.data, sizeof(msg.data), "%f %f", rx, ry);
+                        msg_init(&msg, MSG_TYPE_DRONE);
+                        msg.data.pos.x = rx;
+                        msg.data.pos.y = ry;
                         if(write(fd_bb_out, &msg, sizeof(msg)) < 0) perror("write bb");
                         // -----------------------------
 
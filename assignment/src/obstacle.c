@@ -17,6 +17,9 @@
 #include "app_common.h"
 #include "log.h"
 #include "process_pid.h"
+#include "ipc_frame.h"
+#include "ipc_ring.h"
+#include "free_cells.h"
 
 typedef enum { STATE_INIT, STATE_WAITING, STATE_GENERATING } ProcessState;
 static volatile sig_atomic_t current_state = STATE_INIT;
@@ -64,7 +67,7 @@ void watchdog_ping_handler(int sig) {
 
 /* ======================================================================================
  * SECTION 3: GENERATION LOGIC
- * Creates random obstacles avoiding overlap.
+ * Creates random obstacles avoiding overlap (free-cell pool, no retries).
  * ====================================================================================== */
 Point* generate_obstacles(int width, int height, int* num_out) {
     int total_cells = (width - 2) * (height - 2);
@@ -78,20 +81,10 @@ Point* generate_obstacles(int width, int height, int* num_out) {
     }
 
     srand(time(NULL)); 
-    for (int i = 0; i < count; i++) {
-        int valid;
-        do {
-            valid = 1;
-            arr[i].x = rand() % (width - 2) + 1;
-            arr[i].y = rand() % (height - 2) + 1;
-            // Check self-overlap
-            for (int j = 0; j < i; j++) {
-                if (arr[i].x == arr[j].x && arr[i].y == arr[j].y) {
-                    valid = 0;
-                    break;
-                }
-            }
-        } while (!valid);
+    count = free_cells_pick(width, height, NULL, 0, arr, count);
+    if (count < 0) {
+        logMessage(LOG_PATH, "[OBST] ERROR malloc: %s", strerror(errno));
+        exit(1);
     }
     logMessage(LOG_PATH, "[OBST] Generated %d obstacles", count);
     *num_out = count;
@@ -106,6 +99,10 @@ int main(int argc, char *argv[]) {
 
     int fd_in  = atoi(argv[1]);
     int fd_out = atoi(argv[2]);
+    if (argc > 3) {
+        int fds[2] = { fd_in, fd_out };
+        if (ring_attach(argv[3], fds, 2) == 0) logMessage(LOG_PATH, "[OBST] Shared-memory rings: %s", argv[3]);
+    }
 
     logMessage(LOG_PATH, "[OBST] Started");
 
@@ -129,6 +126,8 @@ int main(int argc, char *argv[]) {
     flock(fd_pid, LOCK_UN);
     fclose(fp_pid);
 
+    FrameReader rx = {0};
+
     // --- MAIN LOOP ---
     while (1) {
         current_state = STATE_WAITING;
@@ -139,6 +138,7 @@ int main(int argc, char *argv[]) {
         tv.tv_sec = 0;
         tv.tv_usec = 200000;
 
+        frame_wait_prepare(fd_in);
         int ret = select(fd_in + 1, &set, NULL, NULL, &tv);
         
         if (ret < 0) {
@@ -148,40 +148,46 @@ int main(int argc, char *argv[]) {
         }
 
         if (FD_ISSET(fd_in, &set)) {
-            Message msg;
-            ssize_t n = read(fd_in, &msg, sizeof(msg));
+            ssize_t n = frame_fill(&rx, fd_in);
 
+            if (n < 0 && errno == EAGAIN) continue;   // Ring wakeup for bytes already consumed
             if (n <= 0) {
                 logMessage(LOG_PATH, "[OBST] Pipe closed, exiting.");
                 break;
             }
 
-            // On MSG_TYPE_SIZE, generate obstacles
-            if (msg.type == MSG_TYPE_SIZE) {
-                current_state = STATE_GENERATING;
-                int width, height;
-                if (sscanf(msg.data, "%d %d", &width, &height) == 2) {
-                    int num_obst = 0;
-                    Point* arr = generate_obstacles(width, height, &num_obst);
-                    
-                    Message out_msg;
-                    out_msg.type = MSG_TYPE_OBSTACLES;
-                    snprintf(out_msg.data, sizeof(out_msg.data), "%d", num_obst);
-                    
-                    write(fd_out, &out_msg, sizeof(out_msg));
-                    write(fd_out, arr, sizeof(Point) * num_obst);
-                    free(arr);
+            Message msg;
+            const void *payload;
+            size_t payload_len;
+            while (frame_next(&rx, &msg, &payload, &payload_len)) {
+                if (!msg_valid(&msg)) continue;
+
+                // On MSG_TYPE_SIZE, generate obstacles
+                if (msg.type == MSG_TYPE_SIZE) {
+                    current_state = STATE_GENERATING;
+                    int width = msg.data.size.width, height = msg.data.size.height;
+                    if (width > 0 && height > 0) {
+                        int num_obst = 0;
+                        Point* arr = generate_obstacles(width, height, &num_obst);
+                        
+                        Message out_msg;
+                        msg_init(&out_msg, MSG_TYPE_OBSTACLES);
+                        out_msg.data.array.count = num_obst;
+                        frame_send(fd_out, &out_msg, arr, sizeof(Point) * num_obst);
+                        free(arr);
+                    }
                 }
-            }
-            else if(msg.type == MSG_TYPE_EXIT){
+                else if(msg.type == MSG_TYPE_EXIT){
 
-                logMessage(LOG_PATH, "[DRONE] Received EXIT signal. Shutting down.");
-                goto quit;
-                
+                    logMessage(LOG_PATH, "[DRONE] Received EXIT signal. Shutting down.");
+                    goto quit;
+                    
+                }
             }
         }
     }
     quit:
+    frame_reader_free(&rx);
     close(fd_in);
     close(fd_out);
     return 0;
@@ -0,0 +1,27 @@
+#include "occupancy_bitmap.h"
+#include <stdlib.h>
+#include <string.h>
+
+int bitmap_resize(OccupancyBitmap *b, int w, int h) {
+    if (w <= 0 || h <= 0) return -1;
+    int wpr = (w + 63) / 64;
+    uint64_t *tmp = realloc(b->words, sizeof(uint64_t) * (size_t)wpr * h);
+    if (!tmp) return -1;
+    b->words = tmp;
+    b->w = w;
+    b->h = h;
+    b->words_per_row = wpr;
+    memset(b->words, 0, sizeof(uint64_t) * (size_t)wpr * h);
+    return 0;
+}
+
+void bitmap_fill(OccupancyBitmap *b, const Point *points, int count) {
+    if (!b->words) return;
+    memset(b->words, 0, sizeof(uint64_t) * (size_t)b->words_per_row * b->h);
+    for (int i = 0; i < count; i++) bitmap_set(b, points[i].x, points[i].y);
+}
+
+void bitmap_free(OccupancyBitmap *b) {
+    free(b->words);
+    memset(b, 0, sizeof(*b));
+}
@@ -0,0 +1,42 @@
+// occupancy_bitmap.h
+#ifndef OCCUPANCY_BITMAP_H
+#define OCCUPANCY_BITMAP_H
+
+#include <stdint.h>
+#include "app_common.h"
+
+/* * Packed 1-bit-per-cell occupancy map of the window (row-major, 64 cells per word).
+ * Cells outside the window always read as free.
+ */
+typedef struct {
+    int w, h;
+    int words_per_row;
+    uint64_t *words;
+} OccupancyBitmap;
+
+// Sizes the map for a w x h window and clears it. Returns 0 on success.
+int bitmap_resize(OccupancyBitmap *b, int w, int h);
+
+// Clears the map and marks every point of the array
+void bitmap_fill(OccupancyBitmap *b, const Point *points, int count);
+
+static inline int bitmap_inside(const OccupancyBitmap *b, int x, int y) {
+    return b->words && x >= 0 && y >= 0 && x < b->w && y < b->h;
+}
+
+static inline int bitmap_test(const OccupancyBitmap *b, int x, int y) {
+    if (!bitmap_inside(b, x, y)) return 0;
+    return (b->words[y * b->words_per_row + (x >> 6)] >> (x & 63)) & 1u;
+}
+
+static inline void bitmap_set(OccupancyBitmap *b, int x, int y) {
+    if (bitmap_inside(b, x, y)) b->words[y * b->words_per_row + (x >> 6)] |= (uint64_t)1 << (x & 63);
+}
+
+static inline void bitmap_reset(OccupancyBitmap *b, int x, int y) {
+    if (bitmap_inside(b, x, y)) b->words[y * b->words_per_row + (x >> 6)] &= ~((uint64_t)1 << (x & 63));
+}
+
+void bitmap_free(OccupancyBitmap *b);
+
+#endif
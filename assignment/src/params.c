@@ -0,0 +1,35 @@
+#include "params.h"
+#include <stdio.h>
+#include <string.h>
+
+/* * Scans the parameter file for `key` and copies its value into out.
+ * Returns 1 if found, 0 otherwise.
+ */
+static int lookup(const char *key, char *out, int out_sz) {
+    FILE *fp = fopen(PARAMS_FILE_PATH, "r");
+    if (!fp) return 0;
+
+    char line[256], tag[128], value[128];
+    int found = 0;
+    while (!found && fgets(line, sizeof(line), fp)) {
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%127s %127s", tag, value) == 2 && strcmp(tag, key) == 0) {
+            snprintf(out, out_sz, "%s", value);
+            found = 1;
+        }
+    }
+    fclose(fp);
+    return found;
+}
+
+int param_int(const char *key, int def) {
+    char value[128];
+    int v;
+    if (lookup(key, value, sizeof(value)) && sscanf(value, "%d", &v) == 1) return v;
+    return def;
+}
+
+const char* param_str(const char *key, const char *def, char *out, int out_sz) {
+    if (!lookup(key, out, out_sz)) snprintf(out, out_sz, "%s", def);
+    return out;
+}
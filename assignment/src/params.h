@@ -0,0 +1,14 @@
+// params.h
+#ifndef PARAMS_H
+#define PARAMS_H
+
+// Runtime parameter file, one "KEY value" pair per line ('#' starts a comment)
+#define PARAMS_FILE_PATH "./params.txt"
+
+// Returns the integer value of `key`, or `def` if the key (or the file) is missing
+int param_int(const char *key, int def);
+
+// Copies the string value of `key` into out (or `def` if missing). Returns out.
+const char* param_str(const char *key, const char *def, char *out, int out_sz);
+
+#endif
@@ -0,0 +1,104 @@
+#include "potential_field.h"
+#include "log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define FIELD_RADIUS (rho + 0.5f)   // Same influence radius used by the drone
+#define FIELD_NODE_MAX MAX_FORCE    // Node clamp: keeps the 1/d^3 peak from bleeding into neighbours
+
+int field_resize(ForceField *f, int w, int h) {
+    if (w <= 0 || h <= 0) return -1;
+    w *= FIELD_SUBDIV;
+    h *= FIELD_SUBDIV;
+    size_t nodes = (size_t)(w + 1) * (size_t)(h + 1);
+    float *nx = realloc(f->fx, sizeof(float) * nodes);
+    if (!nx) return -1;
+    f->fx = nx;
+    float *ny = realloc(f->fy, sizeof(float) * nodes);
+    if (!ny) return -1;
+    f->fy = ny;
+    f->w = w;
+    f->h = h;
+    memset(f->fx, 0, sizeof(float) * nodes);
+    memset(f->fy, 0, sizeof(float) * nodes);
+    return 0;
+}
+
+/* * Recomputes the nodes in [x0..x1] x [y0..y1] (lattice units, clamped),
+ * summing only the obstacles the grid reports around each node.
+ */
+static void recompute_region(ForceField *f, SpatialGrid *grid, const Point *points,
+                             int x0, int y0, int x1, int y1) {
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > f->w) x1 = f->w;
+    if (y1 > f->h) y1 = f->h;
+
+    for (int j = y0; j <= y1; j++) {
+        for (int i = x0; i <= x1; i++) {
+            float px = (float)i / FIELD_SUBDIV, py = (float)j / FIELD_SUBDIV;
+            int n = grid_query(grid, px, py, FIELD_RADIUS, &f->hits);
+            float fx = 0.0f, fy = 0.0f;
+            if (n > 0) {
+                soa_gather(&f->scratch, points, f->hits.idx, n);
+                force_accumulate(f->scratch.x, f->scratch.y, f->scratch.count, px, py, &fx, &fy);
+                float mag = sqrtf(fx*fx + fy*fy);
+                if (mag > FIELD_NODE_MAX) {
+                    fx = fx / mag * FIELD_NODE_MAX;
+                    fy = fy / mag * FIELD_NODE_MAX;
+                }
+            }
+            size_t k = (size_t)j * (f->w + 1) + i;
+            f->fx[k] = fx;
+            f->fy[k] = fy;
+        }
+    }
+}
+
+void field_rebuild(ForceField *f, SpatialGrid *grid, const Point *points) {
+    if (!f->fx) return;
+    recompute_region(f, grid, points, 0, 0, f->w, f->h);
+    logMessage(LOG_PATH, "[FIELD] Rebuilt %dx%d force field", f->w + 1, f->h + 1);
+}
+
+void field_update_cell(ForceField *f, SpatialGrid *grid, const Point *points, Point cell) {
+    if (!f->fx) return;
+    float cx = (float)cell.x + 0.5f;
+    float cy = (float)cell.y + 0.5f;
+    recompute_region(f, grid, points,
+                     (int)floorf((cx - FIELD_RADIUS) * FIELD_SUBDIV), (int)floorf((cy - FIELD_RADIUS) * FIELD_SUBDIV),
+                     (int)ceilf((cx + FIELD_RADIUS) * FIELD_SUBDIV),  (int)ceilf((cy + FIELD_RADIUS) * FIELD_SUBDIV));
+}
+
+void field_sample(const ForceField *f, float x, float y, float *fx, float *fy) {
+    if (!f->fx) return;
+
+    // Clamp to the lattice, then interpolate between the 4 surrounding nodes
+    x *= FIELD_SUBDIV;
+    y *= FIELD_SUBDIV;
+    if (x < 0.0f) x = 0.0f;
+    if (y < 0.0f) y = 0.0f;
+    if (x > (float)f->w) x = (float)f->w;
+    if (y > (float)f->h) y = (float)f->h;
+
+    int i = (int)x, j = (int)y;
+    if (i >= f->w) i = f->w - 1;
+    if (j >= f->h) j = f->h - 1;
+    float tx = x - (float)i, ty = y - (float)j;
+
+    int stride = f->w + 1;
+    size_t k00 = (size_t)j * stride + i, k10 = k00 + 1;
+    size_t k01 = k00 + stride,           k11 = k01 + 1;
+
+    *fx += (1-ty) * ((1-tx) * f->fx[k00] + tx * f->fx[k10]) + ty * ((1-tx) * f->fx[k01] + tx * f->fx[k11]);
+    *fy += (1-ty) * ((1-tx) * f->fy[k00] + tx * f->fy[k10]) + ty * ((1-tx) * f->fy[k01] + tx * f->fy[k11]);
+}
+
+void field_free(ForceField *f) {
+    free(f->fx);
+    free(f->fy);
+    soa_free(&f->scratch);
+    grid_hits_free(&f->hits);
+    memset(f, 0, sizeof(*f));
+}
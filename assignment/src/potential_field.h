@@ -0,0 +1,41 @@
+// potential_field.h
+#ifndef POTENTIAL_FIELD_H
+#define POTENTIAL_FIELD_H
+
+#include "app_common.h"
+#include "spatial_grid.h"
+#include "force_kernel.h"
+
+#define FIELD_SUBDIV 4   // Lattice nodes per window cell along each axis
+
+/* * Precomputed repulsive force field.
+ * Holds the obstacle force on a lattice with FIELD_SUBDIV nodes per window
+ * cell; the drone samples it with bilinear interpolation.
+ */
+typedef struct {
+    int w, h;          // Lattice has (w+1) x (h+1) nodes (window size * FIELD_SUBDIV)
+    float *fx, *fy;
+    PointSoA scratch;  // Kernel buffers used while recomputing nodes
+    GridHits hits;
+} ForceField;
+
+// (Re)allocates the lattice for a w x h window. Returns 0 on success.
+int field_resize(ForceField *f, int w, int h);
+
+/* * Recomputes every node from the obstacles indexed by `grid`.
+ * `points` must be the array the grid was built on.
+ */
+void field_rebuild(ForceField *f, SpatialGrid *grid, const Point *points);
+
+/* * Recomputes only the nodes that an obstacle on `cell` can influence
+ * (its rho-radius patch). Call it for both the old and the new cell of a
+ * relocated obstacle, after the grid has been updated.
+ */
+void field_update_cell(ForceField *f, SpatialGrid *grid, const Point *points, Point cell);
+
+// Bilinear sample of the field at (x, y), added to *fx, *fy
+void field_sample(const ForceField *f, float x, float y, float *fx, float *fy);
+
+void field_free(ForceField *f);
+
+#endif
@@ -0,0 +1,107 @@
+#include "reactor.h"
+#include "app_common.h"
+#include "log.h"
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+int reactor_init(Reactor *r) {
+    for (int i = 0; i < REACTOR_MAX_HANDLERS; i++) r->handlers[i].fd = -1;
+    r->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (r->epfd < 0) {
+        logMessage(LOG_PATH, "[REACTOR] ERROR epoll_create1: %s", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static int add_handler(Reactor *r, int fd, uint32_t events, int is_timer, ReactorFn fn, void *ctx) {
+    for (int i = 0; i < REACTOR_MAX_HANDLERS; i++) {
+        ReactorHandler *h = &r->handlers[i];
+        if (h->fd != -1) continue;
+
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = events;
+        ev.data.ptr = h;
+        if (epoll_ctl(r->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            logMessage(LOG_PATH, "[REACTOR] ERROR adding fd %d: %s", fd, strerror(errno));
+            return -1;
+        }
+        h->fd = fd;
+        h->is_timer = is_timer;
+        h->fn = fn;
+        h->ctx = ctx;
+        return 0;
+    }
+    logMessage(LOG_PATH, "[REACTOR] ERROR no free slot for fd %d", fd);
+    return -1;
+}
+
+int reactor_add(Reactor *r, int fd, uint32_t events, ReactorFn fn, void *ctx) {
+    return add_handler(r, fd, events, 0, fn, ctx);
+}
+
+void reactor_del(Reactor *r, int fd) {
+    for (int i = 0; i < REACTOR_MAX_HANDLERS; i++) {
+        if (r->handlers[i].fd == fd) {
+            epoll_ctl(r->epfd, EPOLL_CTL_DEL, fd, NULL);
+            r->handlers[i].fd = -1;
+            return;
+        }
+    }
+}
+
+int reactor_set_timer(int tfd, long period_ns) {
+    struct itimerspec its;
+    its.it_interval.tv_sec = period_ns / 1000000000L;
+    its.it_interval.tv_nsec = period_ns % 1000000000L;
+    its.it_value = its.it_interval;
+    return timerfd_settime(tfd, 0, &its, NULL);
+}
+
+int reactor_add_timer(Reactor *r, long period_ns, ReactorFn fn, void *ctx) {
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (tfd < 0) {
+        logMessage(LOG_PATH, "[REACTOR] ERROR timerfd_create: %s", strerror(errno));
+        return -1;
+    }
+    if (reactor_set_timer(tfd, period_ns) < 0 || add_handler(r, tfd, EPOLLIN, 1, fn, ctx) < 0) {
+        close(tfd);
+        return -1;
+    }
+    return tfd;
+}
+
+int reactor_run_once(Reactor *r, int timeout_ms) {
+    struct epoll_event events[REACTOR_MAX_EVENTS];
+    int n = epoll_wait(r->epfd, events, REACTOR_MAX_EVENTS, timeout_ms);
+    if (n < 0) return -1;
+
+    for (int i = 0; i < n; i++) {
+        ReactorHandler *h = events[i].data.ptr;
+        if (h->fd == -1) continue;   // Removed by an earlier handler of this batch
+
+        uint32_t ev = events[i].events;
+        if (h->is_timer) {
+            uint64_t expirations = 0;
+            if (read(h->fd, &expirations, sizeof(expirations)) != sizeof(expirations)) continue;
+            ev = (uint32_t)expirations;
+        }
+        h->fn(h->fd, ev, h->ctx);
+    }
+    return n;
+}
+
+void reactor_free(Reactor *r) {
+    for (int i = 0; i < REACTOR_MAX_HANDLERS; i++) {
+        ReactorHandler *h = &r->handlers[i];
+        if (h->fd == -1) continue;
+        epoll_ctl(r->epfd, EPOLL_CTL_DEL, h->fd, NULL);
+        if (h->is_timer) close(h->fd);
+        h->fd = -1;
+    }
+    if (r->epfd >= 0) close(r->epfd);
+    r->epfd = -1;
+}
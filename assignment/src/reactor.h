@@ -0,0 +1,57 @@
+// reactor.h
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <stdint.h>
+#include <sys/epoll.h>
+
+#define REACTOR_MAX_HANDLERS 16   // Registered descriptors (pipes, timers, stdin)
+#define REACTOR_MAX_EVENTS   16   // Events dispatched per epoll_wait()
+
+/* * Called with the ready descriptor and its epoll events (EPOLLIN, EPOLLHUP...).
+ * For a timer, `events` is the number of expirations since the last call.
+ */
+typedef void (*ReactorFn)(int fd, uint32_t events, void *ctx);
+
+typedef struct {
+    int fd;              // -1 when the slot is free
+    int is_timer;        // timerfd: the reactor reads the expiration count itself
+    ReactorFn fn;
+    void *ctx;
+} ReactorHandler;
+
+/* * epoll-based event loop: every descriptor has its own handler and the loop
+ * sleeps until one of them is ready (no polling, no fixed sleep).
+ */
+typedef struct {
+    int epfd;
+    ReactorHandler handlers[REACTOR_MAX_HANDLERS];
+} Reactor;
+
+// Returns 0 on success, -1 if epoll could not be created
+int reactor_init(Reactor *r);
+
+// Registers fd for `events` (EPOLLIN...). Returns 0 on success.
+int reactor_add(Reactor *r, int fd, uint32_t events, ReactorFn fn, void *ctx);
+
+// Unregisters fd (does not close it)
+void reactor_del(Reactor *r, int fd);
+
+/* * Creates a periodic timerfd (first expiry after one period) handled by fn.
+ * Returns the timer descriptor, or -1 on error.
+ */
+int reactor_add_timer(Reactor *r, long period_ns, ReactorFn fn, void *ctx);
+
+// Changes the period of a timer created by reactor_add_timer()
+int reactor_set_timer(int tfd, long period_ns);
+
+/* * Waits up to timeout_ms (-1 = until an event) and dispatches the ready handlers.
+ * Returns the number of events dispatched, 0 on timeout, -1 with errno set
+ * (EINTR when a signal arrived).
+ */
+int reactor_run_once(Reactor *r, int timeout_ms);
+
+// Unregisters everything, closes the timers and the epoll descriptor
+void reactor_free(Reactor *r);
+
+#endif
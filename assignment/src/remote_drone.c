@@ -0,0 +1,85 @@
+#include "remote_drone.h"
+#include <string.h>
+
+#define REMOTE_OFFSET_RELAX 256   // The clock offset climbs 1/256 of the way to a later arrival
+
+// i-th newest sample (0 = newest)
+static const RemoteSample* sample(const RemoteDrone *r, int i) {
+    return &r->hist[(r->head - i + REMOTE_HISTORY) % REMOTE_HISTORY];
+}
+
+// A gap between two updates in which the drone did not move
+static int is_pause(const RemoteDrone *r, long gap) {
+    return gap >= REMOTE_PAUSE_MS || (r->interval_ms > 0.0f && gap > REMOTE_PAUSE_INTERVALS * r->interval_ms);
+}
+
+void remote_drone_init(RemoteDrone *r, int id) {
+    memset(r, 0, sizeof(*r));
+    r->id = id;
+}
+
+void remote_drone_push(RemoteDrone *r, uint32_t sender_ms, long local_ms, float x, float y) {
+    long t = sender_ms;
+    int32_t gap = (int32_t)(sender_ms - r->last_sender_ms);
+    if (r->count > 0 && gap < -REMOTE_PAUSE_MS) remote_drone_init(r, r->id);   // Sender clock restarted: start over
+    if (r->count > 0) {
+        if (gap <= 0) return;   // Duplicate or older than the newest one
+        t = sample(r, 0)->t_ms + gap;
+        if (!is_pause(r, gap)) r->interval_ms = r->interval_ms > 0.0f ? r->interval_ms * 0.875f + gap * 0.125f : gap;
+    }
+
+    double offset = (double)local_ms - t;
+    if (r->count == 0 || offset < r->offset_ms) r->offset_ms = offset;
+    else r->offset_ms += (offset - r->offset_ms) / REMOTE_OFFSET_RELAX;
+    r->late_ms = r->late_ms * 0.875f + (float)(offset - r->offset_ms) * 0.125f;
+
+    r->head = (r->head + 1) % REMOTE_HISTORY;
+    r->hist[r->head] = (RemoteSample){ t, x, y };
+    if (r->count < REMOTE_HISTORY) r->count++;
+    r->last_sender_ms = sender_ms;
+}
+
+int remote_drone_auto_delay(const RemoteDrone *r) {
+    int delay = (int)(r->interval_ms * 1.5f + r->late_ms);
+    return delay > REMOTE_DELAY_MAX_MS ? REMOTE_DELAY_MAX_MS : delay;
+}
+
+void remote_drone_at(const RemoteDrone *r, long local_ms, int delay_ms, int extrap_ms, float *x, float *y) {
+    if (r->count == 0) return;
+    double t = local_ms - r->offset_ms - delay_ms;   // On the sender clock
+    const RemoteSample *b = sample(r, 0);
+
+    // Past the newest update: dead reckoning with the velocity of the last two
+    if (t >= b->t_ms) {
+        *x = b->x;
+        *y = b->y;
+        if (r->count < 2 || t - b->t_ms > extrap_ms) return;
+        const RemoteSample *a = sample(r, 1);
+        long dt = b->t_ms - a->t_ms;
+        if (is_pause(r, dt)) return;
+        float k = (float)((t - b->t_ms) / dt);
+        *x += (b->x - a->x) * k;
+        *y += (b->y - a->y) * k;
+        return;
+    }
+
+    // Between two updates: the first one older than t, and the one after it
+    for (int i = 1; i < r->count; i++) {
+        const RemoteSample *a = sample(r, i);
+        if (t < a->t_ms) {
+            b = a;
+            continue;
+        }
+        // After a pause the drone left `a` about one interval before `b` was sent
+        double ta = a->t_ms;
+        if (is_pause(r, b->t_ms - a->t_ms)) ta = b->t_ms - r->interval_ms;
+        float k = t <= ta ? 0.0f : (float)((t - ta) / (b->t_ms - ta));
+        *x = a->x + (b->x - a->x) * k;
+        *y = a->y + (b->y - a->y) * k;
+        return;
+    }
+
+    // Older than the whole history
+    *x = b->x;
+    *y = b->y;
+}
@@ -0,0 +1,53 @@
+// remote_drone.h
+#ifndef REMOTE_DRONE_H
+#define REMOTE_DRONE_H
+
+#include <stdint.h>
+
+#define REMOTE_HISTORY 8          // Updates kept per remote drone
+#define REMOTE_PAUSE_MS 1000      // A longer silence is a pause (updates are only sent on change),
+#define REMOTE_PAUSE_INTERVALS 3  // and so is one of more than 3 update intervals
+#define REMOTE_DELAY_MAX_MS 500   // Upper bound of the automatic render delay
+#define REMOTE_ID_MAX 0xffff      // Drone ids travel as 16 bits on the wire
+
+typedef struct {
+    long t_ms;                    // Sender clock, unwrapped
+    float x, y;
+} RemoteSample;
+
+/* * One remote drone as seen through its network updates: the last few positions
+ * with the sender's timestamps, so it can be drawn at any instant in between
+ * (interpolation) or a little past the newest one (dead reckoning).
+ *
+ * The sender's clock is mapped to the local one with the smallest arrival offset
+ * seen so far, i.e. the least delayed update; it relaxes slowly upwards so that a
+ * clock drift cannot leave it stale. Jitter in the network then no longer shows
+ * in the motion: only the sender's spacing of the samples does.
+ */
+typedef struct {
+    int id;
+    RemoteSample hist[REMOTE_HISTORY];   // Ring buffer, newest at `head`
+    int head, count;
+    uint32_t last_sender_ms;
+    double offset_ms;                    // Local clock - sender clock
+    float interval_ms;                   // Smoothed spacing of the updates (pauses excluded)
+    float late_ms;                       // Smoothed arrival delay beyond the least delayed update
+} RemoteDrone;
+
+void remote_drone_init(RemoteDrone *r, int id);
+
+// A new update: position (x, y) sampled at sender_ms, received at local_ms
+void remote_drone_push(RemoteDrone *r, uint32_t sender_ms, long local_ms, float x, float y);
+
+// Render delay behind the newest update: 1.5 update intervals plus the usual lateness, so the next one usually arrived
+int remote_drone_auto_delay(const RemoteDrone *r);
+
+/* * Position at local time `local_ms - delay_ms`: interpolated between the two
+ * updates around it, or extrapolated with the last velocity for at most
+ * `extrap_ms` past the newest update. Later than that the newest update itself:
+ * updates stop when the drone stops, so it is where the drone stayed.
+ * No-op without updates.
+ */
+void remote_drone_at(const RemoteDrone *r, long local_ms, int delay_ms, int extrap_ms, float *x, float *y);
+
+#endif
@@ -0,0 +1,329 @@
+#include "renderer.h"
+#include "app_common.h"
+#include "log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#define ANSI_STATUS_MAX 512
+#define ANSI_ACS 0x80              // Cell attribute bit: DEC line-drawing character
+
+/* One terminal cell: character + color (| ANSI_ACS). ch == 0 means "unknown". */
+typedef struct {
+    char ch;
+    uint8_t attr;
+} AnsiCell;
+
+/*
+ * The scene is drawn into `cur`; `shown` is what the terminal displays. present()
+ * walks the columns touched since the last frame (lo..hi per row), emits only
+ * the cells that differ and sends the whole escape sequence with one write().
+ */
+typedef struct {
+    struct termios saved;
+    int have_termios;
+    struct sigaction old_winch;
+    int tw, th;                    // Terminal size
+    AnsiCell *cur, *shown;
+    int *lo, *hi;                  // Touched columns per row (lo > hi: none)
+    int cells_cap, rows_cap;
+    char status[ANSI_STATUS_MAX];
+    int status_changed;
+    int clear_screen;              // Next frame starts from an erased terminal
+    char *out;                     // Escape sequence of the frame being assembled
+    size_t out_len, out_cap;
+    unsigned long frames, bytes;
+} AnsiState;
+
+static volatile sig_atomic_t winch_pending = 0;
+
+static void on_winch(int sig) {
+    (void)sig;
+    winch_pending = 1;
+}
+
+// --- Output buffer ---
+
+static void out_put(AnsiState *s, const char *p, size_t n) {
+    if (s->out_len + n > s->out_cap) {
+        size_t cap = s->out_cap ? s->out_cap : 4096;
+        while (cap < s->out_len + n) cap *= 2;
+        char *tmp = realloc(s->out, cap);
+        if (!tmp) return;
+        s->out = tmp;
+        s->out_cap = cap;
+    }
+    memcpy(s->out + s->out_len, p, n);
+    s->out_len += n;
+}
+
+static void out_str(AnsiState *s, const char *p) {
+    out_put(s, p, strlen(p));
+}
+
+static void out_goto(AnsiState *s, int row, int col) {
+    char seq[24];
+    int n = snprintf(seq, sizeof(seq), "\033[%d;%dH", row, col);
+    out_put(s, seq, (size_t)n);
+}
+
+static void write_all(const char *p, size_t n) {
+    while (n > 0) {
+        ssize_t w = write(STDOUT_FILENO, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        p += w;
+        n -= (size_t)w;
+    }
+}
+
+static void write_str(const char *p) {
+    write_all(p, strlen(p));
+}
+
+// --- Frame buffer ---
+
+static void touch(AnsiState *s, int y, int x0, int x1) {
+    if (x0 < s->lo[y]) s->lo[y] = x0;
+    if (x1 > s->hi[y]) s->hi[y] = x1;
+}
+
+static void set_cell(Renderer *r, int x, int y, char ch, uint8_t attr) {
+    AnsiState *s = r->impl;
+    AnsiCell *c = &s->cur[y * r->w + x];
+    c->ch = ch;
+    c->attr = attr;
+}
+
+static void ansi_term_size(Renderer *r, int *w, int *h) {
+    (void)r;
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0 && ws.ws_row > 0) {
+        *w = ws.ws_col;
+        *h = ws.ws_row;
+    } else {
+        *w = 80;
+        *h = 24;
+    }
+}
+
+static int ansi_open(Renderer *r) {
+    AnsiState *s = calloc(1, sizeof(AnsiState));
+    if (!s) return -1;
+    r->impl = s;
+
+    // Keys one at a time without echo (signals still work, like cbreak())
+    if (tcgetattr(STDIN_FILENO, &s->saved) == 0) {
+        struct termios raw = s->saved;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 0;
+        raw.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+        s->have_termios = 1;
+    }
+
+    // No SA_RESTART: the signal interrupts epoll_wait() and the resize key is read
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_winch;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGWINCH, &sa, &s->old_winch);
+
+    ansi_term_size(r, &s->tw, &s->th);
+    // Alternate screen, hidden cursor
+    write_str("\033[?1049h\033[?25l");
+    s->clear_screen = 1;
+    return 0;
+}
+
+static void ansi_close(Renderer *r) {
+    AnsiState *s = r->impl;
+    write_str("\033[0m\033(B\033[?25h\033[?1049l");
+    if (s->have_termios) tcsetattr(STDIN_FILENO, TCSANOW, &s->saved);
+    sigaction(SIGWINCH, &s->old_winch, NULL);
+
+    logMessage(LOG_PATH, "[BB] ANSI renderer: %lu frames, %lu bytes written", s->frames, s->bytes);
+    free(s->cur);
+    free(s->shown);
+    free(s->lo);
+    free(s->hi);
+    free(s->out);
+    free(s);
+    r->impl = NULL;
+}
+
+static void ansi_clear(Renderer *r) {
+    AnsiState *s = r->impl;
+    int w = r->w, h = r->h;
+
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) set_cell(r, x, y, ' ', RC_DEFAULT);
+        set_cell(r, 0, y, 'x', ANSI_ACS);
+        set_cell(r, w - 1, y, 'x', ANSI_ACS);
+        s->lo[y] = 0;
+        s->hi[y] = w - 1;
+    }
+    for (int x = 1; x < w - 1; x++) {
+        set_cell(r, x, 0, 'q', ANSI_ACS);
+        set_cell(r, x, h - 1, 'q', ANSI_ACS);
+    }
+    set_cell(r, 0, 0, 'l', ANSI_ACS);
+    set_cell(r, w - 1, 0, 'k', ANSI_ACS);
+    set_cell(r, 0, h - 1, 'm', ANSI_ACS);
+    set_cell(r, w - 1, h - 1, 'j', ANSI_ACS);
+}
+
+static void ansi_resize(Renderer *r, int w, int h) {
+    AnsiState *s = r->impl;
+    if (w < 2) w = 2;
+    if (h < 2) h = 2;
+
+    if (w * h > s->cells_cap) {
+        AnsiCell *cur = realloc(s->cur, sizeof(AnsiCell) * w * h);
+        if (cur) s->cur = cur;
+        AnsiCell *shown = realloc(s->shown, sizeof(AnsiCell) * w * h);
+        if (shown) s->shown = shown;
+        if (!cur || !shown) return;
+        s->cells_cap = w * h;
+    }
+    if (h > s->rows_cap) {
+        int *lo = realloc(s->lo, sizeof(int) * h);
+        if (lo) s->lo = lo;
+        int *hi = realloc(s->hi, sizeof(int) * h);
+        if (hi) s->hi = hi;
+        if (!lo || !hi) return;
+        s->rows_cap = h;
+    }
+    r->w = w;
+    r->h = h;
+    ansi_term_size(r, &s->tw, &s->th);
+
+    ansi_clear(r);
+    s->status[0] = '\0';
+    s->status_changed = 1;
+    s->clear_screen = 1;
+}
+
+static void ansi_put(Renderer *r, int x, int y, const char *str, int n, RenderColor c) {
+    AnsiState *s = r->impl;
+    if (y < 0 || y >= r->h) return;
+
+    int x0 = x, x1 = x - 1;
+    for (int k = 0; k < n && str[k]; k++, x1++) {
+        if (x + k < 0 || x + k >= r->w) continue;
+        set_cell(r, x + k, y, str[k], (uint8_t)c);
+    }
+    if (x0 < 0) x0 = 0;
+    if (x1 >= r->w) x1 = r->w - 1;
+    if (x0 <= x1) touch(s, y, x0, x1);
+}
+
+static void ansi_status(Renderer *r, const char *text) {
+    AnsiState *s = r->impl;
+    snprintf(s->status, sizeof(s->status), "%s", text);
+    s->status_changed = 1;
+}
+
+static void emit_attr(AnsiState *s, int *cur_attr, uint8_t attr) {
+    // Indexed by RenderColor
+    static const char *const sgr[] = { "\033[39m", "\033[34m", "\033[31m", "\033[32m" };
+    if (*cur_attr == attr) return;
+
+    if (*cur_attr < 0 || ((*cur_attr ^ attr) & ANSI_ACS)) {
+        out_str(s, (attr & ANSI_ACS) ? "\033(0" : "\033(B");
+    }
+    if (*cur_attr < 0 || ((*cur_attr ^ attr) & ~ANSI_ACS)) {
+        int color = attr & ~ANSI_ACS;
+        out_str(s, sgr[color <= RC_TARGET ? color : RC_DEFAULT]);
+    }
+    *cur_attr = attr;
+}
+
+static void ansi_present(Renderer *r) {
+    AnsiState *s = r->impl;
+    int w = r->w;
+    int cur_attr = -1;          // Unknown terminal state: the first cell sets it
+    s->out_len = 0;
+
+    if (s->clear_screen) {
+        out_str(s, "\033[0m\033(B\033[2J");
+        memset(s->shown, 0, sizeof(AnsiCell) * w * r->h);
+        for (int y = 0; y < r->h; y++) {
+            s->lo[y] = 0;
+            s->hi[y] = w - 1;
+        }
+        s->clear_screen = 0;
+        cur_attr = 0;
+    }
+
+    if (s->status_changed) {
+        out_str(s, "\033[1;1H");
+        emit_attr(s, &cur_attr, RC_DEFAULT);
+        size_t len = strlen(s->status);
+        if (len > (size_t)s->tw) len = (size_t)s->tw;
+        out_put(s, s->status, len);
+        out_str(s, "\033[K");
+        s->status_changed = 0;
+    }
+
+    // Scene rows start on terminal row 2; anything past the terminal is clipped
+    int rows = r->h < s->th - 1 ? r->h : s->th - 1;
+    int cols = w < s->tw ? w : s->tw;
+    int cx = -1, cy = -1;
+    for (int y = 0; y < r->h; y++) {
+        int hi = s->hi[y] < cols - 1 ? s->hi[y] : cols - 1;
+        if (y >= rows) hi = -1;
+        for (int x = s->lo[y]; x <= hi; x++) {
+            AnsiCell *c = &s->cur[y * w + x];
+            AnsiCell *o = &s->shown[y * w + x];
+            if (c->ch == o->ch && c->attr == o->attr) continue;
+
+            if (cx != x || cy != y) out_goto(s, y + 2, x + 1);
+            emit_attr(s, &cur_attr, c->attr);
+            out_put(s, &c->ch, 1);
+            cx = x + 1;
+            cy = y;
+            *o = *c;
+        }
+        s->lo[y] = w;
+        s->hi[y] = -1;
+    }
+
+    if (s->out_len == 0) return;
+    if (cur_attr != 0) out_str(s, "\033[39m\033(B");
+    write_all(s->out, s->out_len);
+    s->frames++;
+    s->bytes += s->out_len;
+}
+
+static int ansi_key(Renderer *r) {
+    (void)r;
+    if (winch_pending) {
+        winch_pending = 0;
+        return RENDER_KEY_RESIZE;
+    }
+    unsigned char ch;
+    if (read(STDIN_FILENO, &ch, 1) == 1) return ch;
+    return RENDER_KEY_NONE;
+}
+
+const RendererOps ansi_renderer_ops = {
+    .name = "ansi",
+    .open = ansi_open,
+    .close = ansi_close,
+    .term_size = ansi_term_size,
+    .resize = ansi_resize,
+    .clear = ansi_clear,
+    .put = ansi_put,
+    .status = ansi_status,
+    .present = ansi_present,
+    .key = ansi_key,
+};
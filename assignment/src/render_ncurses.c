@@ -0,0 +1,133 @@
+#include "renderer.h"
+#include <ncurses.h>
+#include <stdlib.h>
+
+/* Scene window below a one-line status window */
+typedef struct {
+    WINDOW *win;
+    WINDOW *status_win;
+} NcursesState;
+
+static WINDOW* create_window(int height, int width, int starty, int startx) {
+    WINDOW *win = newwin(height, width, starty, startx);
+    keypad(win, TRUE); // Enable arrow keys
+    box(win, 0, 0);    // Draw border
+    wnoutrefresh(win);
+    return win;
+}
+
+static void destroy_window(WINDOW *win) {
+    if (!win) return;
+    werase(win);
+    wnoutrefresh(win);
+    doupdate();
+    delwin(win);
+}
+
+static int nc_open(Renderer *r) {
+    NcursesState *s = calloc(1, sizeof(NcursesState));
+    if (!s) return -1;
+    r->impl = s;
+
+    initscr();
+    cbreak();
+    noecho();
+    nodelay(stdscr, TRUE);
+    curs_set(0);
+    start_color();
+    use_default_colors();
+    init_pair(RC_DRONE, COLOR_BLUE, -1);
+    init_pair(RC_OBSTACLE, COLOR_RED, -1);
+    init_pair(RC_TARGET, COLOR_GREEN, -1);
+    refresh();
+    return 0;
+}
+
+static void nc_close(Renderer *r) {
+    NcursesState *s = r->impl;
+    destroy_window(s->win);
+    if (s->status_win) delwin(s->status_win);
+    endwin();
+    free(s);
+    r->impl = NULL;
+}
+
+static void nc_term_size(Renderer *r, int *w, int *h) {
+    (void)r;
+    *w = COLS;
+    *h = LINES;
+}
+
+static void nc_resize(Renderer *r, int w, int h) {
+    NcursesState *s = r->impl;
+
+    // Forced size (client syncing with the server): resize the virtual screen
+    if (h + 1 != LINES || w != COLS) resize_term(h + 1, w);
+
+    if (s->win != NULL) {
+        // Attempt resize, recreate if it fails
+        if (wresize(s->win, h, w) == ERR || mvwin(s->win, 1, 0) == ERR) {
+            destroy_window(s->win);
+            s->win = create_window(h, w, 1, 0);
+
+            wresize(s->status_win, 1, w);
+            mvwin(s->status_win, 0, 0);
+        }
+    } else {
+        s->win = create_window(h, w, 1, 0);
+        s->status_win = newwin(1, w, 0, 0);
+    }
+
+    werase(s->status_win);
+    box(s->win, 0, 0);
+    r->w = w;
+    r->h = h;
+}
+
+static void nc_clear(Renderer *r) {
+    NcursesState *s = r->impl;
+    werase(s->win);
+    box(s->win, 0, 0);
+}
+
+static void nc_put(Renderer *r, int x, int y, const char *str, int n, RenderColor c) {
+    NcursesState *s = r->impl;
+    if (c != RC_DEFAULT) wattron(s->win, COLOR_PAIR(c));
+    mvwaddnstr(s->win, y, x, str, n);
+    if (c != RC_DEFAULT) wattroff(s->win, COLOR_PAIR(c));
+}
+
+static void nc_status(Renderer *r, const char *text) {
+    NcursesState *s = r->impl;
+    werase(s->status_win);
+    mvwprintw(s->status_win, 0, 0, "%s", text);
+}
+
+/* ncurses diffs the virtual screen against the terminal in doupdate() */
+static void nc_present(Renderer *r) {
+    NcursesState *s = r->impl;
+    wnoutrefresh(s->win);
+    wnoutrefresh(s->status_win);
+    doupdate();
+}
+
+static int nc_key(Renderer *r) {
+    (void)r;
+    int ch = getch();
+    if (ch == ERR) return RENDER_KEY_NONE;
+    if (ch == KEY_RESIZE) return RENDER_KEY_RESIZE;
+    return ch;
+}
+
+const RendererOps ncurses_renderer_ops = {
+    .name = "ncurses",
+    .open = nc_open,
+    .close = nc_close,
+    .term_size = nc_term_size,
+    .resize = nc_resize,
+    .clear = nc_clear,
+    .put = nc_put,
+    .status = nc_status,
+    .present = nc_present,
+    .key = nc_key,
+};
@@ -0,0 +1,145 @@
+#include "renderer.h"
+#include "app_common.h"
+#include "app_blackboard.h"
+#include "log.h"
+#include "params.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NULL_STATUS_MAX 512
+#define SNAPSHOT_PERIOD_MS_DEFAULT 1000
+
+/*
+ * Headless backend: the scene is drawn into a plain character buffer and never
+ * reaches a terminal. With BB_SNAPSHOT_FILE set, present() appends the frame
+ * to that file at most once every BB_SNAPSHOT_PERIOD_MS.
+ */
+typedef struct {
+    char *cells;                   // w * h characters, no colors
+    int cap;
+    char status[NULL_STATUS_MAX];
+    FILE *snap;                    // NULL: snapshots disabled
+    long period_ms;
+    struct timespec t0, last_snap;
+    unsigned long frames, snapshots;
+} NullState;
+
+static long elapsed_ms(const struct timespec *from, const struct timespec *to) {
+    return (to->tv_sec - from->tv_sec) * 1000L + (to->tv_nsec - from->tv_nsec) / 1000000L;
+}
+
+static int null_open(Renderer *r) {
+    NullState *s = calloc(1, sizeof(NullState));
+    if (!s) return -1;
+    r->impl = s;
+
+    char path[256];
+    param_str("BB_SNAPSHOT_FILE", "", path, sizeof(path));
+    s->period_ms = param_int("BB_SNAPSHOT_PERIOD_MS", SNAPSHOT_PERIOD_MS_DEFAULT);
+    if (path[0]) {
+        s->snap = fopen(path, "w");
+        if (!s->snap) logMessage(LOG_PATH, "[BB] ERROR opening snapshot file %s", path);
+        else logMessage(LOG_PATH, "[BB] Headless snapshots: %s every %ld ms", path, s->period_ms);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &s->t0);
+    s->last_snap = s->t0;
+    s->last_snap.tv_sec -= 1 + s->period_ms / 1000;   // First frame is always dumped
+    return 0;
+}
+
+static void null_close(Renderer *r) {
+    NullState *s = r->impl;
+    logMessage(LOG_PATH, "[BB] Headless renderer: %lu frames, %lu snapshots", s->frames, s->snapshots);
+    if (s->snap) fclose(s->snap);
+    free(s->cells);
+    free(s);
+    r->impl = NULL;
+}
+
+/* No terminal: the scene gets the default window size of app_blackboard.h */
+static void null_term_size(Renderer *r, int *w, int *h) {
+    (void)r;
+    *w = WIDTH;
+    *h = HEIGHT + 1;   // Status bar
+}
+
+static void null_clear(Renderer *r) {
+    NullState *s = r->impl;
+    int w = r->w, h = r->h;
+
+    memset(s->cells, ' ', (size_t)w * h);
+    for (int x = 0; x < w; x++) {
+        s->cells[x] = '-';
+        s->cells[(h - 1) * w + x] = '-';
+    }
+    for (int y = 0; y < h; y++) {
+        s->cells[y * w] = '|';
+        s->cells[y * w + w - 1] = '|';
+    }
+    s->cells[0] = s->cells[w - 1] = '+';
+    s->cells[(h - 1) * w] = s->cells[h * w - 1] = '+';
+}
+
+static void null_resize(Renderer *r, int w, int h) {
+    NullState *s = r->impl;
+    if (w < 2) w = 2;
+    if (h < 2) h = 2;
+    if (w * h > s->cap) {
+        char *tmp = realloc(s->cells, (size_t)w * h);
+        if (!tmp) return;
+        s->cells = tmp;
+        s->cap = w * h;
+    }
+    r->w = w;
+    r->h = h;
+    s->status[0] = '\0';
+    null_clear(r);
+}
+
+static void null_put(Renderer *r, int x, int y, const char *str, int n, RenderColor c) {
+    (void)c;
+    NullState *s = r->impl;
+    if (y < 0 || y >= r->h) return;
+    for (int k = 0; k < n && str[k]; k++) {
+        if (x + k >= 0 && x + k < r->w) s->cells[y * r->w + x + k] = str[k];
+    }
+}
+
+static void null_status(Renderer *r, const char *text) {
+    NullState *s = r->impl;
+    snprintf(s->status, sizeof(s->status), "%s", text);
+}
+
+static void null_present(Renderer *r) {
+    NullState *s = r->impl;
+    s->frames++;
+    if (!s->snap) return;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (elapsed_ms(&s->last_snap, &now) < s->period_ms) return;
+    s->last_snap = now;
+    s->snapshots++;
+
+    fprintf(s->snap, "=== frame %lu t=%.3fs ===\n%s\n", s->frames, elapsed_ms(&s->t0, &now) / 1000.0, s->status);
+    for (int y = 0; y < r->h; y++) {
+        fwrite(s->cells + y * r->w, 1, (size_t)r->w, s->snap);
+        fputc('\n', s->snap);
+    }
+    fflush(s->snap);
+}
+
+const RendererOps null_renderer_ops = {
+    .name = "null",
+    .open = null_open,
+    .close = null_close,
+    .term_size = null_term_size,
+    .resize = null_resize,
+    .clear = null_clear,
+    .put = null_put,
+    .status = null_status,
+    .present = null_present,
+    .key = NULL,        // Nothing to read: the blackboard does not watch stdin
+};
@@ -0,0 +1,26 @@
+#include "renderer.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const RendererOps *const backends[] = {
+    &ncurses_renderer_ops,
+    &ansi_renderer_ops,
+    &null_renderer_ops,
+};
+
+Renderer* renderer_create(const char *name) {
+    for (size_t i = 0; i < sizeof(backends) / sizeof(backends[0]); i++) {
+        if (strcmp(name, backends[i]->name) != 0) continue;
+
+        Renderer *r = calloc(1, sizeof(Renderer));
+        if (r) r->ops = backends[i];
+        return r;
+    }
+    return NULL;
+}
+
+void renderer_destroy(Renderer *r) {
+    if (!r) return;
+    if (r->impl) r->ops->close(r);
+    free(r);
+}
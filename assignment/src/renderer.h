@@ -0,0 +1,57 @@
+// renderer.h
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#define RENDERER_DEFAULT "ncurses"   // BB_RENDERER in params.txt
+
+#define RENDER_KEY_NONE   (-1)       // No key waiting
+#define RENDER_KEY_RESIZE (-2)       // The terminal was resized
+
+/* Colors of the scene entities (same palette in every backend) */
+typedef enum {
+    RC_DEFAULT,
+    RC_DRONE,       // Blue
+    RC_OBSTACLE,    // Red
+    RC_TARGET       // Green
+} RenderColor;
+
+typedef struct Renderer Renderer;
+
+/* * Backend operations used by the blackboard's draw functions.
+ * Scene coordinates: (0, 0) is the top-left corner of the border and the scene
+ * sits right below the one-line status bar. Drawing only changes the backend's
+ * copy of the frame; nothing reaches the terminal before present().
+ */
+typedef struct {
+    const char *name;
+    int  (*open)(Renderer *r);                      // Takes over the terminal, 0 on success
+    void (*close)(Renderer *r);                     // Gives the terminal back
+    void (*term_size)(Renderer *r, int *w, int *h); // Current terminal size
+    void (*resize)(Renderer *r, int w, int h);      // Scene becomes w x h (border included)
+    void (*clear)(Renderer *r);                     // Blank scene inside its border
+    void (*put)(Renderer *r, int x, int y, const char *s, int n, RenderColor c);
+    void (*status)(Renderer *r, const char *text);  // Replaces the status bar text
+    void (*present)(Renderer *r);                   // Shows the frame in one terminal update
+    int  (*key)(Renderer *r);                       // Next key, RENDER_KEY_RESIZE or RENDER_KEY_NONE
+                                                    // (NULL: no keyboard, stdin is not watched)
+} RendererOps;
+
+struct Renderer {
+    const RendererOps *ops;
+    int w, h;           // Scene size (border included), set by resize()
+    void *impl;         // Backend state
+};
+
+extern const RendererOps ncurses_renderer_ops;
+extern const RendererOps ansi_renderer_ops;
+extern const RendererOps null_renderer_ops;
+
+/* * Allocates the backend called `name` ("ncurses", "ansi", "null").
+ * Returns NULL for an unknown name. The terminal is untouched until open().
+ */
+Renderer* renderer_create(const char *name);
+
+// Closes the backend if it was opened and frees it
+void renderer_destroy(Renderer *r);
+
+#endif
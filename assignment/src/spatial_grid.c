@@ -0,0 +1,159 @@
+#include "spatial_grid.h"
+#include "log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static int ensure_capacity(int **buf, int *cap, int needed) {
+    if (needed <= *cap) return 0;
+    if (needed < *cap * 2) needed = *cap * 2;   // Geometric, so appending one point at a time stays cheap
+    int *tmp = realloc(*buf, sizeof(int) * needed);
+    if (!tmp) return -1;
+    *buf = tmp;
+    *cap = needed;
+    return 0;
+}
+
+static inline int cell_col(const SpatialGrid *g, float x) {
+    return (int)floorf((x - (float)g->origin_x) / g->cell);
+}
+
+static inline int cell_row(const SpatialGrid *g, float y) {
+    return (int)floorf((y - (float)g->origin_y) / g->cell);
+}
+
+void grid_build(SpatialGrid *g, const Point *points, int count, float cell) {
+    g->points = points;
+    g->num_points = 0;
+    g->cell = cell;
+    g->cols = g->rows = 0;
+    if (!points || count <= 0) return;
+
+    // 1. Bounding box of the points decides the grid extent
+    int min_x = points[0].x, max_x = points[0].x;
+    int min_y = points[0].y, max_y = points[0].y;
+    for (int i = 1; i < count; i++) {
+        if (points[i].x < min_x) min_x = points[i].x;
+        if (points[i].x > max_x) max_x = points[i].x;
+        if (points[i].y < min_y) min_y = points[i].y;
+        if (points[i].y > max_y) max_y = points[i].y;
+    }
+    g->origin_x = min_x;
+    g->origin_y = min_y;
+    g->cols = (int)((max_x - min_x + 1) / cell) + 1;
+    g->rows = (int)((max_y - min_y + 1) / cell) + 1;
+
+    // 2. Storage (kept across rebuilds, only grows)
+    int cells = g->cols * g->rows;
+    if (ensure_capacity(&g->head, &g->head_cap, cells) < 0 ||
+        ensure_capacity(&g->next, &g->point_cap, count) < 0) {
+        logMessage(LOG_PATH, "[GRID] ERROR allocating index for %d points", count);
+        g->cols = g->rows = 0;
+        return;
+    }
+    memset(g->head, 0xff, sizeof(int) * cells);
+
+    // 3. Bucket every point by the cell of its center
+    for (int i = count - 1; i >= 0; i--) {
+        int c = cell_col(g, points[i].x + 0.5f);
+        int r = cell_row(g, points[i].y + 0.5f);
+        int k = r * g->cols + c;
+        g->next[i] = g->head[k];
+        g->head[k] = i;
+    }
+    g->num_points = count;
+}
+
+// Unlinks idx from the bucket of `at` (buckets hold a handful of points); -1 if it is not there
+static int unlink_point(SpatialGrid *g, int idx, Point at) {
+    int c = cell_col(g, at.x + 0.5f);
+    int r = cell_row(g, at.y + 0.5f);
+    if (c < 0 || r < 0 || c >= g->cols || r >= g->rows) return -1;
+    int *link = &g->head[r * g->cols + c];
+    while (*link >= 0 && *link != idx) link = &g->next[*link];
+    if (*link != idx) return -1;
+    *link = g->next[idx];
+    return 0;
+}
+
+// Links idx into the bucket of points[idx]; -1 if it lies outside the grid
+static int link_point(SpatialGrid *g, int idx) {
+    int c = cell_col(g, g->points[idx].x + 0.5f);
+    int r = cell_row(g, g->points[idx].y + 0.5f);
+    if (c < 0 || r < 0 || c >= g->cols || r >= g->rows) return -1;
+    g->next[idx] = g->head[r * g->cols + c];
+    g->head[r * g->cols + c] = idx;
+    return 0;
+}
+
+void grid_move(SpatialGrid *g, int idx, Point old) {
+    if (idx < 0 || idx >= g->num_points) return;
+    const Point *p = &g->points[idx];
+    if (cell_col(g, p->x + 0.5f) == cell_col(g, old.x + 0.5f) &&
+        cell_row(g, p->y + 0.5f) == cell_row(g, old.y + 0.5f)) return;
+    if (unlink_point(g, idx, old) < 0 || link_point(g, idx) < 0)
+        grid_build(g, g->points, g->num_points, g->cell);
+}
+
+void grid_add(SpatialGrid *g, const Point *points) {
+    int idx = g->num_points;
+    g->points = points;
+    if (ensure_capacity(&g->next, &g->point_cap, idx + 1) < 0 || link_point(g, idx) < 0) {
+        grid_build(g, points, idx + 1, g->cell);
+        return;
+    }
+    g->num_points++;
+}
+
+void grid_remove(SpatialGrid *g, int idx, Point removed) {
+    int last = g->num_points - 1;
+    if (idx < 0 || idx > last) return;
+    int ok = unlink_point(g, idx, removed) == 0;
+    if (ok && idx != last) ok = unlink_point(g, last, g->points[idx]) == 0 && link_point(g, idx) == 0;
+    g->num_points--;
+    if (!ok) grid_build(g, g->points, g->num_points, g->cell);
+}
+
+int grid_query(const SpatialGrid *g, float x, float y, float radius, GridHits *hits) {
+    int n = 0;
+    if (g->num_points == 0) return 0;
+    if (ensure_capacity(&hits->idx, &hits->cap, g->num_points) < 0) return 0;
+
+    int c0 = cell_col(g, x - radius), c1 = cell_col(g, x + radius);
+    int r0 = cell_row(g, y - radius), r1 = cell_row(g, y + radius);
+    if (c0 < 0) c0 = 0;
+    if (r0 < 0) r0 = 0;
+    if (c1 >= g->cols) c1 = g->cols - 1;
+    if (r1 >= g->rows) r1 = g->rows - 1;
+
+    for (int r = r0; r <= r1; r++) {
+        for (int c = c0; c <= c1; c++) {
+            for (int i = g->head[r * g->cols + c]; i >= 0; i = g->next[i]) {
+                hits->idx[n++] = i;
+            }
+        }
+    }
+    return n;
+}
+
+int grid_point_at(const SpatialGrid *g, Point p) {
+    int c = cell_col(g, p.x + 0.5f);
+    int r = cell_row(g, p.y + 0.5f);
+    if (g->num_points == 0 || c < 0 || r < 0 || c >= g->cols || r >= g->rows) return -1;
+    for (int i = g->head[r * g->cols + c]; i >= 0; i = g->next[i]) {
+        if (g->points[i].x == p.x && g->points[i].y == p.y) return i;
+    }
+    return -1;
+}
+
+void grid_free(SpatialGrid *g) {
+    free(g->head);
+    free(g->next);
+    memset(g, 0, sizeof(*g));
+}
+
+void grid_hits_free(GridHits *hits) {
+    free(hits->idx);
+    hits->idx = NULL;
+    hits->cap = 0;
+}
@@ -0,0 +1,66 @@
+// spatial_grid.h
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include "app_common.h"
+
+/* * Uniform cell-bucket index over a set of Points.
+ * Every point is stored in the bucket of the cell that contains its center
+ * (x + 0.5, y + 0.5). Buckets are singly linked lists threaded through `next`,
+ * so a query only walks the cells overlapping the search radius.
+ */
+typedef struct {
+    float cell;          // Cell edge length (world units)
+    int origin_x;        // World coordinate of the first column
+    int origin_y;        // World coordinate of the first row
+    int cols, rows;
+
+    int *head;           // First point index of each cell, -1 if empty
+    int  head_cap;
+    int *next;           // Next point index in the same cell, -1 at the end
+    int  point_cap;
+
+    const Point *points; // Borrowed: owned by the caller
+    int num_points;
+} SpatialGrid;
+
+/* * Result buffer of grid_query(). Owned by the caller, so several threads can
+ * query the same grid at once with their own buffers.
+ */
+typedef struct {
+    int *idx;
+    int cap;
+} GridHits;
+
+// Rebuilds the whole index for `points` (the array must outlive the grid use)
+void grid_build(SpatialGrid *g, const Point *points, int count, float cell);
+
+/* * Re-buckets point `idx` after the caller moved it (points[idx] already holds
+ * the new position, `old` the previous one). A point leaving the grid extent
+ * triggers a full rebuild.
+ */
+void grid_move(SpatialGrid *g, int idx, Point old);
+
+/* * Indexes points[num_points], just appended by the caller (`points` may have
+ * moved with the append). A point outside the grid extent triggers a full rebuild.
+ */
+void grid_add(SpatialGrid *g, const Point *points);
+
+/* * Forgets point `idx`, which the caller removed by moving its last point into
+ * slot idx (unless idx was the last); `removed` is where idx used to be.
+ */
+void grid_remove(SpatialGrid *g, int idx, Point removed);
+
+/* * Collects the indices of all points whose center may lie within `radius`
+ * of (x, y) into hits->idx. The result is a superset: callers still apply
+ * the exact cull. Returns the number of indices written.
+ */
+int grid_query(const SpatialGrid *g, float x, float y, float radius, GridHits *hits);
+
+// Index of a point lying exactly on p, -1 if none (walks p's bucket only)
+int grid_point_at(const SpatialGrid *g, Point p);
+
+void grid_free(SpatialGrid *g);
+void grid_hits_free(GridHits *hits);
+
+#endif
@@ -0,0 +1,84 @@
+#include "step_scheduler.h"
+#include "app_common.h"
+#include "log.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+// Upper bounds (ns) of the wake-jitter histogram buckets; the last one is open
+static const long hist_bounds[SCHED_HIST_BUCKETS - 1] = {
+    10000, 50000, 100000, 250000, 500000, 1000000, 2000000, 5000000
+};
+
+static long diff_ns(struct timespec a, struct timespec b) {
+    return (b.tv_sec - a.tv_sec) * 1000000000L + (b.tv_nsec - a.tv_nsec);
+}
+
+static void add_ns(struct timespec *t, long ns) {
+    t->tv_nsec += ns;
+    while (t->tv_nsec >= 1000000000L) {
+        t->tv_nsec -= 1000000000L;
+        t->tv_sec++;
+    }
+}
+
+void sched_init(StepScheduler *s, long period_ns) {
+    memset(s, 0, sizeof(*s));
+    s->period_ns = period_ns;
+    clock_gettime(CLOCK_MONOTONIC, &s->last_wake);
+    s->next_deadline = s->last_wake;
+    add_ns(&s->next_deadline, period_ns);
+}
+
+int sched_wait(StepScheduler *s) {
+    // 1. Sleep until the absolute deadline (signals such as the watchdog ping interrupt it)
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &s->next_deadline, NULL) == EINTR);
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    s->ticks++;
+
+    // 2. Wake-up jitter: how late we are with respect to the deadline
+    long jitter = diff_ns(s->next_deadline, now);
+    if (jitter < 0) jitter = 0;
+    if (jitter > s->max_jitter_ns) s->max_jitter_ns = jitter;
+    int b = 0;
+    while (b < SCHED_HIST_BUCKETS - 1 && jitter >= hist_bounds[b]) b++;
+    s->jitter_hist[b]++;
+
+    // 3. Accumulate real elapsed time and convert it into whole steps
+    s->accumulator_ns += diff_ns(s->last_wake, now);
+    s->last_wake = now;
+    int steps = (int)(s->accumulator_ns / s->period_ns);
+    if (steps > SCHED_MAX_CATCHUP) {
+        s->dropped_steps += steps - SCHED_MAX_CATCHUP;
+        steps = SCHED_MAX_CATCHUP;
+        s->accumulator_ns = 0;
+    } else {
+        s->accumulator_ns -= (long)steps * s->period_ns;
+    }
+    s->steps += steps;
+
+    // 4. Next deadline stays on the fixed grid; if we fell behind, skip the missed ticks
+    add_ns(&s->next_deadline, s->period_ns);
+    if (diff_ns(now, s->next_deadline) <= 0) {
+        s->overruns++;
+        long behind = diff_ns(s->next_deadline, now);
+        add_ns(&s->next_deadline, (behind / s->period_ns + 1) * s->period_ns);
+    }
+    return steps;
+}
+
+void sched_log_stats(const StepScheduler *s, const char *tag) {
+    char hist[256];
+    int off = 0;
+    for (int b = 0; b < SCHED_HIST_BUCKETS && off < (int)sizeof(hist); b++) {
+        if (b < SCHED_HIST_BUCKETS - 1)
+            off += snprintf(hist + off, sizeof(hist) - off, "<%ldus:%lu ", hist_bounds[b] / 1000, s->jitter_hist[b]);
+        else
+            off += snprintf(hist + off, sizeof(hist) - off, ">=%ldus:%lu", hist_bounds[b - 1] / 1000, s->jitter_hist[b]);
+    }
+    logMessage(LOG_PATH, "%s ticks=%lu steps=%lu overruns=%lu dropped=%lu max_jitter=%ldus",
+               tag, s->ticks, s->steps, s->overruns, s->dropped_steps, s->max_jitter_ns / 1000);
+    logMessage(LOG_PATH, "%s jitter histogram: %s", tag, hist);
+}
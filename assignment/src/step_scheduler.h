@@ -0,0 +1,40 @@
+// step_scheduler.h
+#ifndef STEP_SCHEDULER_H
+#define STEP_SCHEDULER_H
+
+#include <time.h>
+
+#define SCHED_MAX_CATCHUP  50   // Max physics steps run in one wake-up after a stall
+#define SCHED_HIST_BUCKETS 9
+
+/* * Fixed-timestep scheduler driven by absolute deadlines.
+ * The loop sleeps with clock_nanosleep(TIMER_ABSTIME) until the next tick,
+ * and an accumulator of elapsed time decides how many fixed steps to run,
+ * so the simulated rate does not depend on how long each iteration took.
+ */
+typedef struct {
+    long period_ns;
+    struct timespec next_deadline;
+    struct timespec last_wake;
+    long accumulator_ns;
+
+    // Statistics
+    unsigned long ticks;
+    unsigned long steps;
+    unsigned long overruns;       // Ticks whose deadline had already passed
+    unsigned long dropped_steps;  // Steps discarded beyond SCHED_MAX_CATCHUP
+    long max_jitter_ns;
+    unsigned long jitter_hist[SCHED_HIST_BUCKETS];
+} StepScheduler;
+
+void sched_init(StepScheduler *s, long period_ns);
+
+/* * Sleeps until the next deadline and returns how many fixed steps the
+ * caller must run now (0..SCHED_MAX_CATCHUP).
+ */
+int sched_wait(StepScheduler *s);
+
+// Writes counters and the wake-jitter histogram to the log
+void sched_log_stats(const StepScheduler *s, const char *tag);
+
+#endif
@@ -0,0 +1,172 @@
+#include "swarm.h"
+#include "log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <math.h>
+
+typedef struct {
+    Swarm *s;
+    int id;
+} WorkerArg;
+
+static WorkerArg worker_args[SWARM_MAX_THREADS];
+static pthread_mutex_t start_gate = PTHREAD_MUTEX_INITIALIZER;   // Held by swarm_init until the barriers are sized
+
+/* * Runs fn on the drones [first, last) through a temporary Drone view. */
+static void step_range(Swarm *s, int first, int last, WorkerScratch *scratch) {
+    for (int i = first; i < last; i++) {
+        Drone d = {0};
+        d.x = s->x[i];     d.y = s->y[i];
+        d.x_1 = s->x_1[i]; d.y_1 = s->y_1[i];
+        d.x_2 = s->x_2[i]; d.y_2 = s->y_2[i];
+        d.vx = s->vx[i];   d.vy = s->vy[i];
+
+        s->fn(i, &d, scratch, s->ctx);
+
+        s->x[i] = d.x;     s->y[i] = d.y;
+        s->x_1[i] = d.x_1; s->y_1[i] = d.y_1;
+        s->x_2[i] = d.x_2; s->y_2[i] = d.y_2;
+        s->vx[i] = d.vx;   s->vy[i] = d.vy;
+    }
+}
+
+static void chunk_bounds(const Swarm *s, int id, int *first, int *last) {
+    int per = (s->count + s->threads - 1) / s->threads;
+    *first = id * per;
+    *last = *first + per;
+    if (*first > s->count) *first = s->count;
+    if (*last > s->count) *last = s->count;
+}
+
+static void* worker_main(void *arg) {
+    WorkerArg *wa = arg;
+    Swarm *s = wa->s;
+    pthread_mutex_lock(&start_gate);
+    pthread_mutex_unlock(&start_gate);
+    while (1) {
+        pthread_barrier_wait(&s->start);
+        if (s->quit) break;
+        int first, last;
+        chunk_bounds(s, wa->id, &first, &last);
+        step_range(s, first, last, &s->scratch[wa->id]);
+        pthread_barrier_wait(&s->done);
+    }
+    return NULL;
+}
+
+int swarm_init(Swarm *s, int count, int threads) {
+    memset(s, 0, sizeof(*s));
+    if (count <= 0) return -1;
+    if (threads < 1) threads = 1;
+    if (threads > SWARM_MAX_THREADS) threads = SWARM_MAX_THREADS;
+    if (count < SWARM_PARALLEL_MIN) threads = 1;
+
+    s->count = count;
+    float **arrays[] = { &s->x, &s->y, &s->x_1, &s->y_1, &s->x_2, &s->y_2, &s->vx, &s->vy };
+    for (size_t k = 0; k < sizeof(arrays) / sizeof(arrays[0]); k++) {
+        *arrays[k] = calloc(count, sizeof(float));
+        if (!*arrays[k]) {
+            logMessage(LOG_PATH, "[SWARM] ERROR allocating %d drones", count);
+            swarm_free(s);
+            return -1;
+        }
+    }
+
+    s->threads = threads;
+    s->scratch = calloc(threads, sizeof(WorkerScratch));
+    s->tids = calloc(threads, sizeof(pthread_t));
+    if (!s->scratch || !s->tids) {
+        swarm_free(s);
+        return -1;
+    }
+
+    if (threads > 1) {
+        // Workers must not steal the watchdog signal from the main thread
+        sigset_t block, old;
+        sigemptyset(&block);
+        sigaddset(&block, SIGUSR1);
+        pthread_sigmask(SIG_BLOCK, &block, &old);
+
+        // The barriers count the workers actually started, so they wait at the gate meanwhile
+        pthread_mutex_lock(&start_gate);
+        int started = 1;
+        while (started < threads) {
+            worker_args[started].s = s;
+            worker_args[started].id = started;
+            if (pthread_create(&s->tids[started], NULL, worker_main, &worker_args[started]) != 0) {
+                logMessage(LOG_PATH, "[SWARM] ERROR starting worker %d, running on %d thread(s)", started, started);
+                break;
+            }
+            started++;
+        }
+        threads = s->threads = started;
+        if (threads > 1) {
+            pthread_barrier_init(&s->start, NULL, threads);
+            pthread_barrier_init(&s->done, NULL, threads);
+        }
+        pthread_mutex_unlock(&start_gate);
+        pthread_sigmask(SIG_SETMASK, &old, NULL);
+    }
+    logMessage(LOG_PATH, "[SWARM] %d drones, %d thread(s)", count, threads);
+    return 0;
+}
+
+void swarm_spawn(Swarm *s, float cx, float cy, int win_width, int win_height) {
+    int side = (int)ceilf(sqrtf((float)s->count));
+    for (int i = 0; i < s->count; i++) {
+        float x = cx + 2.0f * (i % side - side / 2);
+        float y = cy + 2.0f * (i / side - side / 2);
+        // Keep everyone inside the borders
+        if (x < 2.0f) x = 2.0f;
+        if (y < 2.0f) y = 2.0f;
+        if (x > win_width - 3.0f) x = win_width - 3.0f;
+        if (y > win_height - 3.0f) y = win_height - 3.0f;
+        s->x[i] = s->x_1[i] = s->x_2[i] = x;
+        s->y[i] = s->y_1[i] = s->y_2[i] = y;
+        s->vx[i] = s->vy[i] = 0.0f;
+    }
+}
+
+void swarm_step(Swarm *s, SwarmStepFn fn, void *ctx) {
+    s->fn = fn;
+    s->ctx = ctx;
+    if (s->threads == 1) {
+        step_range(s, 0, s->count, &s->scratch[0]);
+        return;
+    }
+    pthread_barrier_wait(&s->start);
+    int first, last;
+    chunk_bounds(s, 0, &first, &last);
+    step_range(s, first, last, &s->scratch[0]);
+    pthread_barrier_wait(&s->done);
+}
+
+void swarm_positions(const Swarm *s, float *out) {
+    for (int i = 0; i < s->count; i++) {
+        out[2*i]     = s->x[i];
+        out[2*i + 1] = s->y[i];
+    }
+}
+
+void swarm_free(Swarm *s) {
+    if (s->threads > 1 && s->tids) {
+        s->quit = 1;
+        pthread_barrier_wait(&s->start);
+        for (int t = 1; t < s->threads; t++) pthread_join(s->tids[t], NULL);
+        pthread_barrier_destroy(&s->start);
+        pthread_barrier_destroy(&s->done);
+    }
+    if (s->scratch) {
+        for (int t = 0; t < s->threads; t++) {
+            grid_hits_free(&s->scratch[t].hits);
+            soa_free(&s->scratch[t].soa);
+        }
+    }
+    free(s->scratch); free(s->tids);
+    free(s->x);   free(s->y);
+    free(s->x_1); free(s->y_1);
+    free(s->x_2); free(s->y_2);
+    free(s->vx);  free(s->vy);
+    memset(s, 0, sizeof(*s));
+}
@@ -0,0 +1,58 @@
+// swarm.h
+#ifndef SWARM_H
+#define SWARM_H
+
+#include <pthread.h>
+#include "app_common.h"
+#include "spatial_grid.h"
+#include "force_kernel.h"
+
+#define SWARM_PARALLEL_MIN 256   // Below this many drones the batch runs on one thread
+#define SWARM_MAX_THREADS  16
+
+/* Per-thread buffers for grid queries and the force kernel */
+typedef struct {
+    GridHits hits;
+    PointSoA soa;
+    unsigned long evals;   // Force evaluations not yet added to the world's total
+} WorkerScratch;
+
+/* * Steps drone `i` in place. `drn` is a temporary AoS view of the drone,
+ * written back to the arrays by the engine afterwards.
+ */
+typedef void (*SwarmStepFn)(int i, Drone *drn, WorkerScratch *scratch, void *ctx);
+
+/* * Multi-drone engine: N drones kept as structure-of-arrays and advanced in
+ * one batched pass, split across a pool of worker threads when N is large.
+ */
+typedef struct {
+    int count;
+    float *x, *y;
+    float *x_1, *y_1, *x_2, *y_2;
+    float *vx, *vy;
+
+    // Worker pool (thread 0 is the caller)
+    int threads;
+    pthread_t *tids;
+    WorkerScratch *scratch;
+    pthread_barrier_t start, done;
+    volatile int quit;
+    SwarmStepFn fn;
+    void *ctx;
+} Swarm;
+
+// Allocates N drones and starts threads-1 workers. Returns 0 on success.
+int swarm_init(Swarm *s, int count, int threads);
+
+// Places the drones on a square lattice (2 cells apart) centered on (cx, cy)
+void swarm_spawn(Swarm *s, float cx, float cy, int win_width, int win_height);
+
+// One batched physics pass over every drone
+void swarm_step(Swarm *s, SwarmStepFn fn, void *ctx);
+
+// Writes interleaved x, y pairs (2 * count floats) into out
+void swarm_positions(const Swarm *s, float *out);
+
+void swarm_free(Swarm *s);
+
+#endif
@@ -18,6 +18,9 @@
 #include "app_common.h"
 #include "log.h"
 #include "process_pid.h"
+#include "ipc_frame.h"
+#include "ipc_ring.h"
+#include "free_cells.h"
 
 static Point *obstacles = NULL;
 static int num_obstacles = 0;
@@ -70,7 +73,7 @@ void watchdog_ping_handler(int signo) {
 
 /* ======================================================================================
  * SECTION 3: GENERATION LOGIC
- * Generates targets checking collision with current Obstacles.
+ * Generates targets on cells free of the current Obstacles (free-cell pool, no retries).
  * ====================================================================================== */
 Point* generate_targets(int width, int height, Point* obstacles, int num_obstacles, int* num_out) {
     int total_cells = (width - 2) * (height - 2);
@@ -80,23 +83,8 @@ Point* generate_targets(int width, int height, Point* obstacles, int num_obstacl
     Point* arr = malloc(sizeof(Point) * count);
     if (!arr) exit(1);
     
-    for (int i = 0; i < count; i++) {
-        int valid;
-        do {
-            valid = 1;
-            arr[i].x = rand() % (width - 2) + 1;
-            arr[i].y = rand() % (height - 2) + 1;
-            
-            // Check self-overlap
-            for (int j = 0; j < i; j++) {
-                if (arr[i].x == arr[j].x && arr[i].y == arr[j].y) { valid = 0; break; }
-            }
-            // Check obstacle-overlap
-            for (int j = 0; j < num_obstacles && valid; j++) {
-                if (arr[i].x == obstacles[j].x && arr[i].y == obstacles[j].y) { valid = 0; break; }
-            }
-        } while (!valid);
-    }
+    count = free_cells_pick(width, height, obstacles, num_obstacles, arr, count);
+    if (count < 0) exit(1);
     logMessage(LOG_PATH, "[TARG] Generated %d targets", count);
     *num_out = count;
     return arr;
@@ -112,6 +100,10 @@ int main(int argc, char *argv[]) {
 
     int fd_in  = atoi(argv[1]);
     int fd_out = atoi(argv[2]);
+    if (argc > 3) {
+        int fds[2] = { fd_in, fd_out };
+        if (ring_attach(argv[3], fds, 2) == 0) logMessage(LOG_PATH, "[TARG] Shared-memory rings: %s", argv[3]);
+    }
     int win_width = 0, win_height = 0;
 
     logMessage(LOG_PATH, "[TARG] Started with PID: %d", getpid());
@@ -136,6 +128,8 @@ int main(int argc, char *argv[]) {
     flock(fd_pid, LOCK_UN);
     fclose(fp_pid);
 
+    FrameReader rx = {0};
+
     // --- MAIN LOOP ---
     while (1) {
         current_state = STATE_WAITING;
@@ -145,6 +139,7 @@ int main(int argc, char *argv[]) {
         struct timeval tv;
         tv.tv_sec = 0;
         tv.tv_usec = 200000;
+        frame_wait_prepare(fd_in);
         int ret = select(fd_in + 1, &set, NULL, NULL, &tv);
         
         if (ret < 0) {
@@ -154,57 +149,65 @@ int main(int argc, char *argv[]) {
         }
 
         if (FD_ISSET(fd_in, &set)) {
-            Message msg;
-            ssize_t n = read(fd_in, &msg, sizeof(msg));
+            ssize_t n = frame_fill(&rx, fd_in);
+            if (n < 0 && errno == EAGAIN) continue;   // Ring wakeup for bytes already consumed
             if (n <= 0) {
                 logMessage(LOG_PATH, "[TARG] Pipe closed, exiting.");
                 break;
             }
 
-            if (msg.type == MSG_TYPE_SIZE) {
-                sscanf(msg.data, "%d %d", &win_width, &win_height);
-            }
-            // Upon receiving obstacles, generate targets
-            else if (msg.type == MSG_TYPE_OBSTACLES) {
-                current_state = STATE_GENERATING;
-                int count = 0;
-                sscanf(msg.data, "%d", &count);
-                
-                free(obstacles);
-                obstacles = NULL;
-                num_obstacles = 0;
-
-                if (count > 0) {
-                    obstacles = malloc(sizeof(Point) * count);
-                    if (obstacles) {
-                        read(fd_in, obstacles, sizeof(Point) * count);
-                        num_obstacles = count;
+            Message msg;
+            const void *payload;
+            size_t payload_len;
+            while (frame_next(&rx, &msg, &payload, &payload_len)) {
+                if (!msg_valid(&msg)) continue;
+
+                if (msg.type == MSG_TYPE_SIZE) {
+                    win_width = msg.data.size.width;
+                    win_height = msg.data.size.height;
+                }
+                // Upon receiving obstacles, generate targets
+                else if (msg.type == MSG_TYPE_OBSTACLES) {
+                    current_state = STATE_GENERATING;
+                    int count = msg.data.array.count;
+                    if (count < 0 || payload_len != sizeof(Point) * (size_t)count) continue;
+                    
+                    free(obstacles);
+                    obstacles = NULL;
+                    num_obstacles = 0;
+
+                    if (count > 0) {
+                        obstacles = malloc(sizeof(Point) * count);
+                        if (obstacles) {
+                            memcpy(obstacles, payload, payload_len);
+                            num_obstacles = count;
+                        }
+                    }
+
+                    if (win_width > 0 && win_height > 0) {
+                        int num_targ = 0;
+                        Point* arr = generate_targets(win_width, win_height, obstacles, num_obstacles, &num_targ);
+                        
+                        Message out_msg;
+                        msg_init(&out_msg, MSG_TYPE_TARGETS);
+                        out_msg.data.array.count = num_targ;
+                        frame_send(fd_out, &out_msg, arr, sizeof(Point) * num_targ);
+                        free(arr);
                     }
                 }
+                else if(msg.type == MSG_TYPE_EXIT){
 
-                if (win_width > 0 && win_height > 0) {
-                    int num_targ = 0;
-                    Point* arr = generate_targets(win_width, win_height, obstacles, num_obstacles, &num_targ);
+                    logMessage(LOG_PATH, "[DRONE] Received EXIT signal. Shutting down.");
+                    goto quit;
                     
-                    Message out_msg;
-                    out_msg.type = MSG_TYPE_TARGETS;
-                    snprintf(out_msg.data, sizeof(out_msg.data), "%d", num_targ);
-                    write(fd_out, &out_msg, sizeof(out_msg));
-                    write(fd_out, arr, sizeof(Point) * num_targ);
-                    free(arr);
                 }
             }
-            else if(msg.type == MSG_TYPE_EXIT){
-
-                logMessage(LOG_PATH, "[DRONE] Received EXIT signal. Shutting down.");
-                goto quit;
-                
-            }
         }
     }
 
     quit:
     free(obstacles);
+    frame_reader_free(&rx);
     close(fd_in);
     close(fd_out);
     return 0;
@@ -17,8 +17,10 @@
 #include <fcntl.h> // <--- CRITICAL: Required for O_NONBLOCK
 
 #include "process_pid.h" 
+#include "app_common.h"
 #include "log.h" 
 
+#undef LOG_PATH   // The watchdog keeps its own log file
 #define LOG_PATH "logs/watchdog.log"
 #define TIMEOUT_US 200000 // 200ms timeout for response
 #define CYCLE_DELAY 2     // Seconds between checks
@@ -117,6 +119,13 @@ void pong_handler(int sig, siginfo_t *info, void *context) {
     }
 }
 
+// Non-blocking check of the Blackboard pipe for the quit message
+int quit_requested(int fd_bb_read) {
+    Message msg;
+    ssize_t n = read(fd_bb_read, &msg, sizeof(msg));
+    return n > 0 && msg_valid(&msg) && msg.type == MSG_TYPE_EXIT;
+}
+
 /* ======================================================================================
  * SECTION 3: MAIN SETUP
  * Initialization, Locking, and Configuration.
@@ -167,12 +176,11 @@ int main(int argc, char *argv[]) {
      * SECTION 4: MONITORING LOOP
      * The infinite loop that checks system health.
      * ====================================================================================== */
-    while (1) {
-        char buf[80];
+    int quitting = 0;
+    while (!quitting) {
         
         // 1. CHECK FOR QUIT SIGNAL (Non-blocking)
-        ssize_t n = read(fd_bb_read, buf, sizeof(buf)-1);
-        if(n > 0){
+        if (quit_requested(fd_bb_read)) {
             w_log("[WATCHDOG] Received quit signal. Exiting.");
             break;
         }
@@ -208,6 +216,11 @@ int main(int argc, char *argv[]) {
                 // Success: The process responded in time
                 w_log("[WATCHDOG] Process %s [PID %d] is responsive!", 
                            process_map[i].name, process_map[i].pid);
+            } else if (quit_requested(fd_bb_read)) {
+                // The system quit during this cycle: the process exited, it did not hang
+                w_log("[WATCHDOG] Received quit signal. Exiting.");
+                quitting = 1;
+                break;
             } else {
                 // Failure: Timeout reached
                 w_log("[WATCHDOG] ALERT! Process %s [PID %d] timed out after %d ms!", 
@@ -219,6 +232,7 @@ int main(int argc, char *argv[]) {
             }
         }
         
+        if (quitting) break;
         w_log("[WATCHDOG] All %d processes checked. Waiting next cycle...", process_count);
         sleep(CYCLE_DELAY);
     }
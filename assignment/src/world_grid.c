@@ -0,0 +1,51 @@
+#include "world_grid.h"
+#include <stdlib.h>
+#include <string.h>
+
+static void world_grid_empty(WorldGrid *g) {
+    for (int i = 0; i < g->w * g->h; i++) {
+        g->cells[i].obstacle = WORLD_EMPTY;
+        g->cells[i].target = WORLD_EMPTY;
+    }
+}
+
+int world_grid_resize(WorldGrid *g, int w, int h) {
+    if (w <= 0 || h <= 0) return -1;
+    WorldCell *tmp = realloc(g->cells, sizeof(WorldCell) * (size_t)w * h);
+    if (!tmp) return -1;
+    g->cells = tmp;
+    g->w = w;
+    g->h = h;
+    world_grid_empty(g);
+    return 0;
+}
+
+void world_grid_rebuild(WorldGrid *g, const Point *obstacles, int num_obstacles,
+                        const Point *targets, int num_targets) {
+    if (!g->cells) return;
+    world_grid_empty(g);
+    for (int i = 0; i < num_obstacles; i++) world_set(g, ENTITY_OBSTACLE, obstacles[i], i);
+    for (int i = 0; i < num_targets; i++) world_set(g, ENTITY_TARGET, targets[i], i);
+}
+
+void world_set(WorldGrid *g, int entity, Point p, int index) {
+    WorldCell *c = world_cell(g, p.x, p.y);
+    if (!c) return;
+    if (entity == ENTITY_OBSTACLE) c->obstacle = index;
+    else c->target = index;
+}
+
+void world_clear(WorldGrid *g, int entity, Point p, int index) {
+    WorldCell *c = world_cell(g, p.x, p.y);
+    if (!c) return;
+    if (entity == ENTITY_OBSTACLE) {
+        if (c->obstacle == index) c->obstacle = WORLD_EMPTY;
+    } else {
+        if (c->target == index) c->target = WORLD_EMPTY;
+    }
+}
+
+void world_grid_free(WorldGrid *g) {
+    free(g->cells);
+    memset(g, 0, sizeof(*g));
+}
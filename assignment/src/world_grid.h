@@ -0,0 +1,63 @@
+// world_grid.h
+#ifndef WORLD_GRID_H
+#define WORLD_GRID_H
+
+#include <stddef.h>
+#include "app_common.h"
+
+#define WORLD_EMPTY (-1)
+
+/* * What lies on one cell: the index of the obstacle and of the target there
+ * (WORLD_EMPTY if none). One slot per entity type, so an obstacle and a target
+ * that the two generator processes happened to put on the same cell are both kept.
+ */
+typedef struct {
+    int obstacle;
+    int target;
+} WorldCell;
+
+/* * Per-cell index of the obstacle and target arrays over a w x h window
+ * (row-major). Cells outside the window are never stored and read as empty.
+ */
+typedef struct {
+    int w, h;
+    WorldCell *cells;
+} WorldGrid;
+
+// Sizes the grid for a w x h window and empties it. Returns 0 on success.
+int world_grid_resize(WorldGrid *g, int w, int h);
+
+// Empties the grid and indexes both arrays again
+void world_grid_rebuild(WorldGrid *g, const Point *obstacles, int num_obstacles,
+                        const Point *targets, int num_targets);
+
+static inline WorldCell* world_cell(const WorldGrid *g, int x, int y) {
+    if (!g->cells || x < 0 || y < 0 || x >= g->w || y >= g->h) return NULL;
+    return &g->cells[y * g->w + x];
+}
+
+static inline int world_obstacle_at(const WorldGrid *g, int x, int y) {
+    const WorldCell *c = world_cell(g, x, y);
+    return c ? c->obstacle : WORLD_EMPTY;
+}
+
+static inline int world_target_at(const WorldGrid *g, int x, int y) {
+    const WorldCell *c = world_cell(g, x, y);
+    return c ? c->target : WORLD_EMPTY;
+}
+
+// 1 if (x, y) is inside the window and holds neither an obstacle nor a target
+static inline int world_cell_free(const WorldGrid *g, int x, int y) {
+    const WorldCell *c = world_cell(g, x, y);
+    return c && c->obstacle == WORLD_EMPTY && c->target == WORLD_EMPTY;
+}
+
+// Entity `index` (ENTITY_OBSTACLE / ENTITY_TARGET) now lies on p
+void world_set(WorldGrid *g, int entity, Point p, int index);
+
+// Entity `index` left p (the cell is untouched if another entity took it over)
+void world_clear(WorldGrid *g, int entity, Point p, int index);
+
+void world_grid_free(WorldGrid *g);
+
+#endif